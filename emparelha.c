@@ -0,0 +1,349 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "grafo.h"
+
+//------------------------------------------------------------------------------
+// calcula um emparelhamento do grafo lido e escreve só o que for pedido
+//
+// uso: emparelha [opções] [arquivo]
+//
+// lê o grafo (formato dot) do arquivo ou da entrada padrão
+//
+//   -a, --algoritmo <alg>   auto (padrão): maximo ou componentes se g é
+//                           bipartido, geral senão; maximo, componentes,
+//                           aproximado, geral, ponderado (peso máximo) ou
+//                           leilao (peso máximo, em paralelo)
+//   -e, --epsilon <e>       erro relativo de aproximado (padrão 0.1)
+//   -f, --formato <fmt>     dot (padrão), arestas (uma linha "u v" por
+//                           aresta), pares (vetor binário, ver abaixo) ou
+//                           tamanho (só o número de arestas)
+//   -o, --saida <arquivo>   escreve no arquivo em vez da saída padrão
+//   -t, --threads <n>       threads de componentes e leilao (padrão 1;
+//                           com mais de uma, auto usa componentes)
+//   -p, --partida <arquivo> começa do emparelhamento do arquivo (formato
+//                           dot, como os _emp.dot de Testes_Raphael, ou
+//                           pares) em vez do vazio; os pares que não servem
+//                           mais para o grafo são descartados (ver
+//                           continua_emparelhamento())
+//   -c, --controle <arquivo> grava o estado do emparelhamento no arquivo
+//                           (formato pares) a cada intervalo segundos e no
+//                           fim; se o arquivo já existe, continua dele
+//                           (em vez de -p), de modo que uma execução
+//                           interrompida pode ser retomada
+//   -n, --intervalo <s>     intervalo entre pontos de controle (padrão 60)
+//   -i, --eco               escreve antes o grafo lido (como teste)
+//   -s, --stats             escreve na saída de erro um objeto JSON com os
+//                           tamanhos, os tempos de leitura, cálculo e
+//                           escrita e, se grafo.c foi compilado com eles,
+//                           os contadores de desempenho (ver
+//                           liga_contadores()) e o uso de memória (ver
+//                           consulta_memoria())
+//
+// o formato pares tem |V(G)| + 1 inteiros sem sinal de 32 bits na ordem da
+// máquina: |V(G)| e, para cada vértice na ordem de vertices_grafo(), a
+// posição do seu par nessa ordem, ou UINT_MAX se ele está livre (ver
+// pares_emparelhamento())
+//
+// -p e -c só valem com o algoritmo maximo (que auto passa a escolher)
+
+//------------------------------------------------------------------------------
+
+static double agora(void) {
+
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+
+  return (double) t.tv_sec + (double) t.tv_nsec / 1e9;
+}
+
+//------------------------------------------------------------------------------
+// escreve a cadeia s como uma cadeia JSON, entre aspas e com aspas, barras
+// invertidas e caracteres de controle escapados
+
+static void escreve_json(FILE *saida, const char *s) {
+
+  fputc('"', saida);
+  for ( ; *s; ++s )
+    if ( *s == '"' || *s == '\\' )
+      fprintf(saida, "\\%c", *s);
+    else if ( (unsigned char) *s < 0x20 )
+      fprintf(saida, "\\u%04x", (unsigned int) (unsigned char) *s);
+    else
+      fputc(*s, saida);
+  fputc('"', saida);
+}
+
+//------------------------------------------------------------------------------
+// escreve as arestas de emparelhamento, uma "u v" por linha
+
+static void escreve_arestas(FILE *saida, grafo emparelhamento) {
+
+  for ( no n = primeiro_no(vertices_grafo(emparelhamento)); n; n = proximo_no(n) ) {
+
+    vertice u = conteudo(n), v;
+    cursor_vizinhanca c;
+
+    // cada aresta está na lista de saída de um só dos seus vértices
+    for ( inicia_vizinhanca(&c, u, 1); (v = proximo_vizinho(&c)); )
+      fprintf(saida, "%s %s\n", nome_vertice(u), nome_vertice(v));
+  }
+}
+
+//------------------------------------------------------------------------------
+// escreve o vetor de pares de emparelhamento em g
+
+static int escreve_pares(FILE *saida, grafo g, grafo emparelhamento) {
+
+  unsigned int *par = pares_emparelhamento(g, emparelhamento);
+  unsigned int n = n_vertices(g);
+  int ok;
+
+  if ( !par )
+    return 0;
+
+  ok = fwrite(&n, sizeof(n), 1, saida) == 1 && fwrite(par, sizeof(*par), n, saida) == n;
+  free(par);
+
+  return ok;
+}
+
+//------------------------------------------------------------------------------
+// lê o vetor de pares de g do arquivo de nome nome, que pode estar no
+// formato pares ou ser um emparelhamento no formato dot
+//
+// devolve NULL em caso de erro
+
+static unsigned int *le_partida(const char *nome, grafo g) {
+
+  FILE *f = fopen(nome, "rb");
+  unsigned int n = 0, *par = NULL;
+  grafo emparelhamento;
+  long tam;
+
+  if ( !f ) {
+
+    perror(nome);
+    return NULL;
+  }
+
+  // no formato pares, o arquivo tem exatamente |V(G)| + 1 inteiros e o
+  // primeiro é |V(G)|
+  if ( fseek(f, 0, SEEK_END) == 0 && (tam = ftell(f)) >= 0 && fseek(f, 0, SEEK_SET) == 0
+       && (unsigned long) tam == (n_vertices(g) + 1UL) * sizeof(n)
+       && fread(&n, sizeof(n), 1, f) == 1 && n == n_vertices(g) ) {
+
+    rewind(f);
+    par = le_pares_emparelhamento(f, g);
+  }
+  else {
+
+    rewind(f);
+    if ( (emparelhamento = le_grafo(f)) ) {
+
+      par = pares_emparelhamento(g, emparelhamento);
+      destroi_grafo(emparelhamento);
+    }
+  }
+  fclose(f);
+
+  if ( !par )
+    fprintf(stderr, "emparelha: erro ao ler o emparelhamento de %s\n", nome);
+
+  return par;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+
+  static const struct option opcoes[] = {
+    { "algoritmo", required_argument, NULL, 'a' },
+    { "epsilon", required_argument, NULL, 'e' },
+    { "formato", required_argument, NULL, 'f' },
+    { "saida", required_argument, NULL, 'o' },
+    { "threads", required_argument, NULL, 't' },
+    { "partida", required_argument, NULL, 'p' },
+    { "controle", required_argument, NULL, 'c' },
+    { "intervalo", required_argument, NULL, 'n' },
+    { "eco", no_argument, NULL, 'i' },
+    { "stats", no_argument, NULL, 's' },
+    { NULL, 0, NULL, 0 }
+  };
+  const char *algoritmo = "auto", *formato = "dot", *partida = NULL, *controle = NULL;
+  double epsilon = 0.1, razao = 1, intervalo = 60, t0, t1, t2, t3;
+  unsigned int n_threads = 1, invalidos = 0, *par = NULL;
+  int opcao, eco = 0, stats = 0, ok = 1;
+  long int peso = 0;
+  FILE *entrada = stdin, *saida = stdout;
+  grafo g, emparelhamento;
+  contadores c;
+  uso_memoria uso[N_MEMORIAS];
+
+  while ( (opcao = getopt_long(argc, argv, "a:e:f:o:t:p:c:n:is", opcoes, NULL)) != -1 ) {
+
+    switch ( opcao ) {
+
+    case 'a': algoritmo = optarg; break;
+    case 'e': epsilon = atof(optarg); break;
+    case 'f': formato = optarg; break;
+    case 't': n_threads = atoi(optarg) > 0 ? (unsigned int) atoi(optarg) : 1; break;
+    case 'p': partida = optarg; break;
+    case 'c': controle = optarg; break;
+    case 'n': intervalo = atof(optarg); break;
+    case 'i': eco = 1; break;
+    case 's': stats = 1; break;
+    case 'o':
+      if ( !(saida = fopen(optarg, "wb")) ) {
+
+        perror(optarg);
+        return 1;
+      }
+      break;
+    default:
+      fprintf(stderr, "uso: emparelha [-a algoritmo] [-e epsilon] [-f formato] [-o saida]"
+              " [-t threads]\n"
+              "               [-p partida] [-c controle] [-n intervalo] [-i] [-s] [arquivo]\n");
+      return 1;
+    }
+  }
+
+  if ( strcmp(formato, "dot") && strcmp(formato, "arestas")
+       && strcmp(formato, "pares") && strcmp(formato, "tamanho") ) {
+
+    fprintf(stderr, "emparelha: formato desconhecido: %s\n", formato);
+    return 1;
+  }
+
+  if ( optind < argc && !(entrada = fopen(argv[optind], "r")) ) {
+
+    perror(argv[optind]);
+    return 1;
+  }
+
+  memset(&c, 0, sizeof(c));
+  if ( stats )
+    liga_contadores(&c);
+
+  t0 = agora();
+  g = le_grafo(entrada);
+  if ( entrada != stdin )
+    fclose(entrada);
+  if ( !g ) {
+
+    fprintf(stderr, "emparelha: erro ao ler o grafo\n");
+    return 1;
+  }
+
+  if ( partida || controle ) {
+
+    if ( strcmp(algoritmo, "auto") && strcmp(algoritmo, "maximo") ) {
+
+      fprintf(stderr, "emparelha: -p e -c só valem com o algoritmo maximo\n");
+      destroi_grafo(g);
+      return 1;
+    }
+    algoritmo = "maximo";
+
+    // um ponto de controle já gravado é mais recente que a partida
+    if ( controle && (entrada = fopen(controle, "rb")) ) {
+
+      fclose(entrada);
+      partida = controle;
+    }
+    if ( partida && !(par = le_partida(partida, g)) ) {
+
+      destroi_grafo(g);
+      return 1;
+    }
+  }
+  t1 = agora();
+
+  if ( !strcmp(algoritmo, "auto") )
+    algoritmo = !bipartido(g, NULL) ? "geral" : n_threads > 1 ? "componentes" : "maximo";
+
+  if ( par || controle )
+    emparelhamento = continua_emparelhamento(g, par, controle, intervalo, &invalidos);
+  else if ( !strcmp(algoritmo, "maximo") )
+    emparelhamento = emparelhamento_maximo(g);
+  else if ( !strcmp(algoritmo, "componentes") )
+    emparelhamento = emparelhamento_componentes(g, n_threads);
+  else if ( !strcmp(algoritmo, "aproximado") )
+    emparelhamento = emparelhamento_aproximado(g, epsilon, &razao);
+  else if ( !strcmp(algoritmo, "geral") )
+    emparelhamento = emparelhamento_geral(g);
+  else if ( !strcmp(algoritmo, "ponderado") )
+    emparelhamento = emparelhamento_ponderado(g, 1, 0, &peso);
+  else if ( !strcmp(algoritmo, "leilao") )
+    emparelhamento = emparelhamento_leilao(g, 1, n_threads, 0, &peso, NULL);
+  else {
+
+    fprintf(stderr, "emparelha: algoritmo desconhecido: %s\n", algoritmo);
+    destroi_grafo(g);
+    return 1;
+  }
+  t2 = agora();
+  free(par);
+
+  if ( !emparelhamento ) {
+
+    fprintf(stderr, "emparelha: %s não se aplica a %s\n", algoritmo, nome_grafo(g));
+    destroi_grafo(g);
+    return 1;
+  }
+
+  if ( eco )
+    escreve_grafo(saida, g);
+
+  if ( !strcmp(formato, "dot") )
+    escreve_grafo(saida, emparelhamento);
+  else if ( !strcmp(formato, "arestas") )
+    escreve_arestas(saida, emparelhamento);
+  else if ( !strcmp(formato, "pares") )
+    ok = escreve_pares(saida, g, emparelhamento);
+  else
+    fprintf(saida, "%u\n", n_arestas(emparelhamento));
+
+  ok = fflush(saida) == 0 && ok;
+  t3 = agora();
+
+  if ( stats ) {
+
+    fprintf(stderr, "{\"algoritmo\": ");
+    escreve_json(stderr, algoritmo);
+    fprintf(stderr, ", \"vertices\": %u, \"arestas\": %u, \"emparelhamento\": %u",
+            n_vertices(g), n_arestas(g), n_arestas(emparelhamento));
+    if ( !strcmp(algoritmo, "aproximado") )
+      fprintf(stderr, ", \"razao_garantida\": %.6f", razao);
+    if ( !strcmp(algoritmo, "ponderado") || !strcmp(algoritmo, "leilao") )
+      fprintf(stderr, ", \"peso\": %ld", peso);
+    if ( partida ) {
+
+      fprintf(stderr, ", \"partida\": ");
+      escreve_json(stderr, partida);
+      fprintf(stderr, ", \"pares_invalidos\": %u", invalidos);
+    }
+    fprintf(stderr, ", \"leitura_ms\": %.3f, \"calculo_ms\": %.3f, \"escrita_ms\": %.3f",
+            (t1 - t0) * 1e3, (t2 - t1) * 1e3, (t3 - t2) * 1e3);
+    if ( liga_contadores(NULL) ) {
+
+      fprintf(stderr, ", \"contadores\": ");
+      escreve_contadores(stderr, &c);
+    }
+    if ( consulta_memoria(uso) ) {
+
+      fprintf(stderr, ", \"memoria\": ");
+      escreve_memoria(stderr);
+    }
+    fprintf(stderr, "}\n");
+  }
+
+  if ( saida != stdout && fclose(saida) != 0 )
+    ok = 0;
+
+  return ! (ok && destroi_grafo(emparelhamento) && destroi_grafo(g));
+}
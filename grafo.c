@@ -1,13 +1,27 @@
+#define _POSIX_C_SOURCE 200809L // clock_gettime
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <errno.h>
 #include <malloc.h>
+#include <pthread.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
 #include <graphviz/cgraph.h>
 #include "grafo.h"
 
 //------------------------------------------------------------------------------
 // Definições extras:
-#define TAM_NOME 64
+#define MAX_NOME 63 // Caracteres de um nome, sem o '\0'
+#define TAM_NOME (MAX_NOME + 1)
+#define TEXTO(x) #x
+#define TEXTO_DE(x) TEXTO(x) // Texto do valor da macro x (ex.: larguras de scanf)
 #define VIZIN_SAIDA 1
 #define VIZIN_COMPL 0
 #define VIZIN_ENTRA -1
@@ -16,12 +30,74 @@
 #define VERM 1
 #define AZUL 2
 #define FDR -1 // Fim de Rotulo
+#define SEM_LIMITE UINT_MAX // Tamanho maximo de caminho aumentante
+#define NENHUM UINT_MAX // Licitante/objeto ausente no leilao
+#define FATOR_EPS 5 // Divisor do epsilon entre fases do leilao
+#define LIMIAR_JACOBI 512 // Licitantes livres por thread pra valer lances paralelos
+#define COMPONENTE_GRANDE 16384 // Componentes com mais vertices usam todas as threads
+#define JANELA_EXTERNO 256 // Vertices da fila da busca em largura antecipados por vez
+#define PAGINA_EXTERNO 4096 // Alinhamento da adjacencia no arquivo do grafo externo (nao eh a pagina do sistema)
+#define LOTE_DISTRIBUIDO 4096 // Arestas (ou arcos) por mensagem entre o coordenador e uma parte
+#define MSG_INICIO 1 // Mensagens do emparelhamento distribuido
+#define MSG_ARESTAS 2
+#define MSG_FIM_ARESTAS 3
+#define MSG_PARES 4
+#define MSG_CAMADA 5
+#define MSG_VIZINHOS 6
+#define MSG_SAIR 7
+#define MSG_FIM_VIZINHOS 8
+#define CACHE_EMPARELHAMENTO 1 // Tipos de resultado guardados no cache
+#define CACHE_LEXICOGRAFICA 2
+#define CACHE_CORDAL 3
+#define BALDES_CACHE 64 // Numero inicial de listas da tabela do cache
+#define LIMITE_CACHE (64ul << 20) // Bytes de resultados guardados no cache, por padrao
+
+//------------------------------------------------------------------------------
+// Contadores de desempenho (ver liga_contadores). Sem -DCONTADORES as macros
+// nao geram codigo nenhum.
+#ifdef CONTADORES
+#define CONTA(campo, n) do { if(contadores_ativos) contadores_ativos->campo += (n); } while(0)
+#define INICIA_FASE(t) double t = contadores_ativos ? agora() : 0
+#define TERMINA_FASE(f, t) do { if(contadores_ativos && (t) > 0) { \
+        contadores_ativos->tempo[f] += agora() - (t); ++contadores_ativos->chamadas[f]; } } while(0)
+// Nas threads auxiliares: conta em parcial se a thread que as criou conta
+// em pai, e soma parcial em pai no fim.
+#define HERDA_CONTADORES(parcial, pai) contadores parcial, *parcial##_antes = contadores_ativos; \
+        memset(&parcial, 0, sizeof(contadores)); contadores_ativos = (pai) ? &parcial : NULL
+#define DEVOLVE_CONTADORES(parcial, pai) do { if(pai) soma_contadores(pai, &parcial); \
+        contadores_ativos = parcial##_antes; } while(0)
+#define CONTADORES_ATIVOS contadores_ativos
+#else
+#define CONTA(campo, n) ((void) 0)
+#define INICIA_FASE(t) ((void) 0)
+#define TERMINA_FASE(f, t) ((void) 0)
+#define HERDA_CONTADORES(parcial, pai) ((void) 0)
+#define DEVOLVE_CONTADORES(parcial, pai) ((void) 0)
+#define CONTADORES_ATIVOS NULL
+#endif
+
+//------------------------------------------------------------------------------
+// Alocacao contada por parte da biblioteca (ver consulta_memoria). Sem
+// -DMEMORIA as macros sao so malloc, calloc, realloc e free.
+#ifdef MEMORIA
+#define ALOCA(tag, n) aloca_memoria(tag, n)
+#define ALOCA_ZERADO(tag, k, n) aloca_zerada_memoria(tag, k, n)
+#define REALOCA(tag, p, n) realoca_memoria(tag, p, n)
+#define LIBERA(p) libera_memoria(p)
+#else
+#define ALOCA(tag, n) malloc(n)
+#define ALOCA_ZERADO(tag, k, n) calloc(k, n)
+#define REALOCA(tag, p, n) realloc(p, n)
+#define LIBERA(p) free(p)
+#endif
+#define PAR 0 // Rotulos da arvore alternante do algoritmo de Edmonds
+#define IMPAR 1
 
 //---------------------------------------------------------------------------
 // nó de lista encadeada cujo conteúdo é um void *
 struct no {
   void *conteudo;
-  no proximo;
+  no proximo, anterior;
 };
 
 //---------------------------------------------------------------------------
@@ -40,13 +116,41 @@ struct lista {
 // Nome = nome do grafo.
 // Int direcao = 1 se o grafo for direcionado, 0 caso contrario.
 // Int ponderado = 1 se o grafo possui peso nas arestas, 0 caso contrario.
+// Marca = ultima marca usada nos vertices (ver proxima_marca).
+// N_arestas = numero de arestas, atualizado por insere_aresta e remove_aresta.
+// Hash = hash canonico (ver hash_grafo), ou 0 se o grafo mudou depois de
+// calculado.
 struct grafo {
 	lista v;
 	char* nome;
 	int direcao;
 	int ponderado;
+	unsigned int marca, n_arestas;
+	unsigned long long hash;
 };
 
+#ifdef MEMORIA
+//------------------------------------------------------------------------------
+// Cabecalho que aloca_memoria poe antes de cada bloco: o tamanho pedido e a
+// parte (enum memoria) a que ele eh atribuido. Tem 16 bytes pra nao mudar o
+// alinhamento que o malloc garante.
+struct cabecalho_memoria {
+	size_t tamanho;
+	unsigned int tag;
+	int padding;
+};
+
+//------------------------------------------------------------------------------
+// Uso de memoria de cada parte, atualizado atomicamente por todas as threads.
+static uso_memoria memoria_usada[N_MEMORIAS];
+#endif
+
+#ifdef CONTADORES
+//------------------------------------------------------------------------------
+// Contadores ligados nesta thread (ver liga_contadores), ou NULL.
+static __thread contadores *contadores_ativos = NULL;
+#endif
+
 //------------------------------------------------------------------------------
 // Estrutura de dados que representa um vértice do grafo.
 // Cada vértice tem um nome, que é uma "string"
@@ -55,11 +159,19 @@ struct grafo {
 // Em grafos nao direcionados, as arestas soh sao inseridas uma vez em cada vertice!
 // Por exemplo, uma aresta a--b aparece na lista de saida do vertice a e na lista de
 // entrada do vertice b..
+// Marca eh usada pelas buscas que nao podem resetar todos os vertices do grafo:
+// um vertice esta marcado numa busca se sua marca eh >= a marca da busca.
+// No_grafo = no do vertice na lista de vertices do grafo (pra remocao em O(1)).
+// Lado = lado do vertice na ultima bipartição calculada por bipartido(); em
+// cada componente, o lado 0 eh o menor, e eh dele que as buscas de caminho
+// aumentante partem.
 struct vertice {
 	char* nome;
 	lista saida, entrada;
+	no no_grafo;
     int *rotulo;
-    int estado, atributo, coberto, visitado, na_arvore, padding;
+    int estado, atributo, coberto, lado, na_arvore;
+    unsigned int marca;
 };
 
 //------------------------------------------------------------------------------
@@ -70,13 +182,43 @@ struct vertice {
 // Vertice vs = vertice de saida.
 // Vertice vc = vertice de chegada.
 // Peso = peso da aresta (0 é o default).
+// No_saida e no_entrada = nos da aresta nas listas vs->saida e vc->entrada,
+// que permitem remover a aresta em O(1).
 typedef struct aresta *aresta;
 struct aresta {
 	vertice vs, vc;
+	no no_saida, no_entrada;
 	long int peso;
     int coberta, padding;
 };
 
+//------------------------------------------------------------------------------
+// Mantem um emparelhamento maximo de um grafo bipartido sob insercoes e
+// remocoes de arestas. O emparelhamento fica marcado no proprio grafo
+// (a->coberta e v->coberto).
+// G = grafo acompanhado.
+// Tamanho = numero de arestas do emparelhamento.
+// Limite = tamanho maximo dos caminhos aumentantes procurados nas chegadas.
+// Periodo = numero de chegadas entre reotimizacoes (0 = nunca).
+// Chegadas = chegadas desde a ultima reotimizacao.
+// Maximo = 1 se o emparelhamento eh sabidamente maximo, 0 se alguma busca
+// limitada falhou desde a ultima reotimizacao.
+struct emparelhamento_dinamico {
+	grafo g;
+	unsigned int tamanho, limite, periodo, chegadas;
+	int maximo, padding;
+};
+
+//------------------------------------------------------------------------------
+// Acompanha a cordalidade de um grafo sob insercoes e remocoes de arestas.
+// G = grafo acompanhado.
+// Cordal = 1 se g eh cordal, 0 se nao eh, ou -1 se nao se sabe (g foi
+// alterado quando nao era cordal e cordal_atual ainda nao foi chamada).
+struct cordal_dinamico {
+	grafo g;
+	int cordal, padding;
+};
+
 //------------------------------------------------------------------------------
 // Protótipos de Funções Auxiliares Criadas:
 
@@ -96,14 +238,16 @@ aresta constroi_aresta(void);
 // Dado um vertice, procura um apontador pra aresta a e remove ele
 void remove_duplicada(void* a, vertice v);
 
-//------------------------------------------------------------------------------
-// Cria um vertice, atribui a ele um nome e insere na lista de vertices do grafo
-vertice insere_vertice(grafo g, char* nome);
-
 //------------------------------------------------------------------------------
 // Cria uma aresta com atributos vs, vc e peso sendo, respectivamente,
 // saida, chegada e peso, e insere nas 2 listas (do vertice de entrada e do de saida).
-aresta insere_aresta(vertice saida, vertice chegada, long int peso);
+// Atualiza o numero de arestas de g.
+aresta insere_aresta(grafo g, vertice saida, vertice chegada, long int peso);
+
+//------------------------------------------------------------------------------
+// Insere a aresta a (com vs e vc ja definidos) nas listas dos seus vertices,
+// guardando os nos correspondentes. Devolve a, ou NULL em caso de erro.
+aresta liga_aresta(grafo g, aresta a);
 
 //------------------------------------------------------------------------------
 // Cria uma copia da aresta e retorna um apontador para a nova aresta
@@ -129,12 +273,6 @@ int destroi_aresta(void *v);
 // usada como parametro da funcao destroi_lista)
 int destroi_vertice(void *v);
 
-//------------------------------------------------------------------------------
-// Procura na lista de vertices do grafo um vertice com o nome do parametro
-// retorna NULL em caso de erro ou caso nao ache o vertice
-// retorna o vertice caso ache ele
-vertice procura_vertice(grafo g, char* nome);
-
 //------------------------------------------------------------------------------
 // Devolve 1, se o vertice v2 é adjacente (ligado por uma aresta) a v, ou
 //         0, caso contrário
@@ -153,10 +291,6 @@ int vertice_clique(vertice v, lista l);
 // lista, retorna 0 caso contrario.
 int na_lista(lista l, void* conteudo);
 
-//------------------------------------------------------------------------------
-// Retorna a lista de vertices de um grafo g
-lista vertices_grafo(grafo g);
-
 //------------------------------------------------------------------------------
 // Imprime o rotulo de um vertice v.
 void imprime_rotulo(vertice v);
@@ -189,6 +323,645 @@ no v_rotulo_maximo(lista l);
 lista busca_largura_lexicografica_vertice(grafo g, vertice r, lista ordem);
 
 
+//------------------------------------------------------------------------------
+// Como proximo_vizinho(), mas devolve a aresta que liga o vertice do cursor
+// ao proximo vizinho.
+aresta proxima_incidente(cursor_vizinhanca *c);
+
+//------------------------------------------------------------------------------
+// Devolve a ponta da aresta a que nao eh v.
+vertice outra_ponta(aresta a, vertice v);
+
+//------------------------------------------------------------------------------
+// Heap binario de (distancia, vertice) usado pelo Dijkstra do emparelhamento
+// ponderado. Eh alocado uma vez e reaproveitado em todas as fases; entradas
+// desatualizadas sao descartadas quando saem do heap.
+struct item_heap {
+    long int d;
+    unsigned int x, padding;
+};
+struct heap {
+    struct item_heap *item;
+    unsigned int n, capacidade;
+};
+
+//------------------------------------------------------------------------------
+// Insere (d, x) no heap h, aumentando-o se preciso. Devolve 0 em caso de erro.
+int insere_heap(struct heap *h, long int d, unsigned int x);
+
+//------------------------------------------------------------------------------
+// Remove o item de menor distancia do heap h (que nao pode estar vazio).
+struct item_heap remove_heap(struct heap *h);
+
+//------------------------------------------------------------------------------
+// Estado do leilao (auction) do emparelhamento ponderado. O problema eh
+// transformado numa atribuicao quadrada: o licitante v e o objeto v existem
+// pra todo vertice v, e o licitante v disputa o objeto v e os objetos dos
+// vizinhos de v. So os lances de licitantes do lado esquerdo em objetos do
+// lado direito correspondem a arestas de g (com beneficio = peso); os demais
+// tem beneficio 0 e representam "ficar de fora" do emparelhamento. Assim toda
+// atribuicao completa eh um emparelhamento de g e vice-versa, e o leilao com
+// epsilon-escalonamento continua correto.
+// Ini/obj/benef/arco = adjacencia compactada (arcos do licitante i estao em
+// [ini[i], ini[i+1])); arco[k] = aresta de g do arco k, ou NULL.
+// Dono[j] = licitante com o objeto j; arco_de[i] = arco atribuido a i.
+// Livres/prox_livres = licitantes livres na rodada atual e na proxima.
+// Lance/lance_arco = lance de cada livre na rodada (modo Jacobi).
+// Vencedor/rodada_obj = melhor lance por objeto na rodada atual.
+// Trava/inicio/fim/passo/pendentes/encerra = sincronizacao das threads.
+struct leilao {
+    unsigned int n, n_livres, n_threads, rodada, passo, pendentes;
+    unsigned int *ini, *obj, *dono, *arco_de, *livres, *prox_livres;
+    unsigned int *lance_arco, *vencedor, *rodada_obj;
+    long int *benef, *preco, *lance;
+    aresta *arco;
+    long int eps;
+    pthread_mutex_t trava;
+    pthread_cond_t inicio, fim;
+    int encerra, padding;
+};
+
+//------------------------------------------------------------------------------
+// Calcula o lance do licitante i: devolve o arco do objeto mais vantajoso e
+// coloca em *lance o novo preco oferecido por ele.
+unsigned int melhor_lance(struct leilao *l, unsigned int i, long int *lance);
+
+//------------------------------------------------------------------------------
+// Calcula os lances da fatia t (de l->n_threads) dos licitantes livres.
+void calcula_lances(struct leilao *l, unsigned int t);
+
+//------------------------------------------------------------------------------
+// Laco das threads auxiliares do leilao: espera um novo passo, calcula os
+// lances da sua fatia e avisa quando termina.
+void *thread_leilao(void *arg);
+
+//------------------------------------------------------------------------------
+// Rodada Jacobi: todos os livres dao lance ao mesmo tempo (em paralelo), e
+// cada objeto fica com o maior lance recebido.
+void rodada_jacobi(struct leilao *l);
+
+//------------------------------------------------------------------------------
+// Gauss-Seidel: processa os livres um de cada vez, ate nao sobrar nenhum.
+void rodadas_gauss_seidel(struct leilao *l);
+
+//------------------------------------------------------------------------------
+// Devolve a diferenca entre o valor dual e o primal da atribuicao atual
+// (completa) de l, que limita o quanto ela esta longe do otimo.
+long int folga_leilao(struct leilao *l);
+
+//------------------------------------------------------------------------------
+// Estado da enumeracao de Murty dos k melhores emparelhamentos. O problema eh
+// uma atribuicao retangular: cada linha (vertice do lado menor) tem que ser
+// atribuida a uma coluna, que eh um vertice do outro lado ou a coluna
+// "ficticia" exclusiva da linha (linha fora do emparelhamento). Os nos do
+// grafo residual sao as linhas [0, n_lin), as colunas [n_lin, n_lin+n_col) e
+// o sorvedouro T = n_lin+n_col.
+// Ini/col/linha/custo/arco = arcos das linhas (arco[k] = aresta de g ou NULL).
+// Arco_de[r] = arco atribuido a linha r; dono[c] = linha da coluna c.
+// Pot = potenciais (custos reduzidos custo + pot[origem] - pot[destino] >= 0).
+// Proib/bloq = arcos proibidos e colunas fixas no subproblema atual
+// (valem quando iguais a carimbo).
+// Dist/marca/pred/feitos/h = estado dos Dijkstras (marca como em
+// emparelhamento_ponderado, com fases 2f e 2f+1).
+struct murty {
+    unsigned int n_lin, n_col, n_nos, carimbo, fase, n_feitos;
+    unsigned int *ini, *col, *linha, *arco_de, *dono, *proib, *bloq;
+    unsigned int *marca, *pred, *feitos;
+    long int *custo, *pot, *dist;
+    aresta *arco;
+    struct heap h;
+};
+
+//------------------------------------------------------------------------------
+// Subproblema de Murty: as linhas [0, f) estao fixas na solucao do pai, e o
+// arco "arco" (da linha f) esta proibido, junto com os arcos proibidos pelos
+// ancestrais com o mesmo f. Enquanto nao resolvido, custo eh o custo do pai
+// (limite inferior) e a solucao do pai eh usada como ponto de partida.
+struct sub_murty {
+    long int custo;
+    long int *pot;
+    unsigned int *arco_de;
+    unsigned int pai, f, arco, filhos;
+    int resolvido, padding;
+};
+
+//------------------------------------------------------------------------------
+// Estado do algoritmo de Edmonds (floracoes) sobre os vertices numerados de g.
+// Par[x] = indice do par de x, ou NENHUM; elo[x] = predecessor de x (x impar)
+// na arvore alternante; base[x] = union-find das floracoes contraidas;
+// rotulo[x] = PAR/IMPAR/NENHUM na busca atual; visita = marcas do lca.
+// Tocados guarda os vertices alterados pela busca, pra limpar so eles.
+struct floracao {
+    vertice *vetor;
+    unsigned int *par, *elo, *base, *rotulo, *visita, *fila, *tocados;
+    unsigned int n, ini, fim, n_tocados, carimbo, padding;
+};
+
+//------------------------------------------------------------------------------
+// Devolve a base da floracao que contem x (com compressao de caminho).
+unsigned int base_floracao(struct floracao *b, unsigned int x);
+
+//------------------------------------------------------------------------------
+// Devolve a base do menor ancestral comum de x e y na floresta alternante.
+unsigned int ancestral_floracao(struct floracao *b, unsigned int x, unsigned int y);
+
+//------------------------------------------------------------------------------
+// Contrai o lado de x do ciclo impar fechado pela aresta xy na base l,
+// colocando na fila os vertices impares que passam a ser pares.
+void contrai_floracao(struct floracao *b, unsigned int x, unsigned int y, unsigned int l);
+
+//------------------------------------------------------------------------------
+// Procura um caminho aumentante a partir do vertice livre r e, se achar,
+// aumenta o emparelhamento com ele. Devolve 1 se aumentou, 0 caso contrario.
+int busca_floracao(struct floracao *b, unsigned int r);
+
+//------------------------------------------------------------------------------
+// Decomposicao em componentes pro emparelhamento em paralelo. Os vertices
+// sao numerados (ver numera_ordem) e a adjacencia fica compactada: os
+// vizinhos de x sao adj[ini[x] .. ini[x+1]), e arco[k] eh a aresta de adj[k].
+// Ordem lista os vertices agrupados por componente: a componente i ocupa
+// ordem[comeco[i] .. comeco[i+1]); as mesmas fatias de pilha servem de pilha
+// pra busca em cada componente.
+// Par[x] = par de x ou NENHUM; visita/iter = marca e proximo arco de cada
+// vertice nas buscas. Como as componentes sao disjuntas, threads em
+// componentes diferentes nunca mexem nas mesmas posicoes desses vetores.
+// Nivel (so em Hopcroft-Karp) = camada de cada vertice do lado 0 na busca em
+// largura; limite = camada dos vertices que alcancam um vertice livre.
+// Lado[x] = lado de x. Com externo, ini/adj/lado apontam pra um grafo_externo
+// mapeado em memoria (e vetor/arco ficam NULL); externo = 2 depois que o
+// sistema recusou antecipar paginas (ver antecipa_externo).
+struct componentes {
+    vertice *vetor;
+    aresta *arco;
+    unsigned int *ini, *adj, *ordem, *comeco, *par, *visita, *iter, *pilha, *nivel;
+    unsigned char *lado;
+    unsigned int n, n_comp, limite, externo;
+};
+
+//------------------------------------------------------------------------------
+// Fila de tarefas (componentes) de uma thread, com roubo de trabalho: a dona
+// tira do fim e as outras threads roubam do inicio.
+struct fila_tarefas {
+    pthread_mutex_t trava;
+    unsigned int *tarefa;
+    unsigned int ini, fim;
+};
+
+//------------------------------------------------------------------------------
+// Estado compartilhado entre as threads do emparelhamento por componentes.
+// Na fase de componentes grandes, as threads pegam os vertices livres de
+// livres[0 .. n_livres) pelo indice proximo e marcam vertices com marca;
+// depois, cada uma esvazia a sua fila e rouba das outras.
+// Contadores = contadores da thread que chamou (ver liga_contadores), ou NULL.
+struct escalonador {
+    struct componentes *c;
+    struct fila_tarefas *filas;
+    unsigned int *livres, *pilhas;
+    contadores *contadores;
+    unsigned int n_threads, proxima_thread, n_livres, proximo, achados, marca, tam_pilha, padding;
+};
+
+//------------------------------------------------------------------------------
+// Procura, com busca em profundidade iterativa, um caminho aumentante a partir
+// do vertice livre u (do lado 0) e, se achar, aumenta o emparelhamento com
+// ele. Os vertices do lado 1 visitados recebem marca; com atomico, a marcacao
+// eh atomica, e buscas simultaneas na mesma componente usam caminhos
+// disjuntos. Com c->nivel, so segue as camadas da busca em largura (caminhos
+// minimos). Devolve 1 se aumentou, 0 caso contrario.
+int aumenta_componente(struct componentes *c, unsigned int u, unsigned int marca, unsigned int *pilha, int atomico);
+
+//------------------------------------------------------------------------------
+// Monta em c a adjacencia compactada de g (bipartido, com lado calculado),
+// com par[] vazio. Devolve 0 em caso de erro.
+int monta_componentes(grafo g, struct componentes *c);
+
+//------------------------------------------------------------------------------
+// Marca em g o emparelhamento dado por c->par e devolve o grafo dele.
+grafo grava_componentes(grafo g, struct componentes *c);
+
+//------------------------------------------------------------------------------
+// Libera os vetores de c.
+void libera_componentes(struct componentes *c);
+
+//------------------------------------------------------------------------------
+// Emparelha gulosamente os vertices livres de c.
+void guloso_componentes(struct componentes *c);
+
+//------------------------------------------------------------------------------
+// Busca em largura de Hopcroft-Karp a partir dos vertices livres do lado 0,
+// preenchendo c->nivel. Devolve o numero de arestas do emparelhamento num
+// caminho aumentante minimo (guardado em c->limite), ou NENHUM se nao ha
+// caminho aumentante.
+// Se livres nao eh NULL, a busca vai ate o fim e *livres recebe o numero de
+// vertices livres do lado 1 alcancados (marcados com marca em c->visita).
+unsigned int camadas_componentes(struct componentes *c, unsigned int marca, unsigned int *livres);
+
+//------------------------------------------------------------------------------
+// Devolve os segundos (relogio de parede) desde um instante fixo.
+double agora(void);
+
+//------------------------------------------------------------------------------
+// Soma os contadores de d em c, com uma trava (as threads auxiliares
+// terminam ao mesmo tempo).
+void soma_contadores(contadores *c, const contadores *d);
+
+//------------------------------------------------------------------------------
+// Grava c->n e c->par no arquivo (ponto de controle de
+// continua_emparelhamento), passando por arquivo.tmp. Devolve 0 em caso de
+// erro.
+int grava_pares(const char *arquivo, struct componentes *c);
+
+#ifdef MEMORIA
+//------------------------------------------------------------------------------
+// Soma alocado - liberado bytes aos vivos da parte tag e do total, subindo
+// os picos se preciso.
+void conta_memoria(unsigned int tag, size_t alocado, size_t liberado);
+
+//------------------------------------------------------------------------------
+// malloc, calloc, realloc e free que contam os bytes na parte tag (ver
+// struct cabecalho_memoria). So libera_memoria pode liberar os blocos
+// devolvidos, e ela so pode liberar esses blocos.
+void *aloca_memoria(unsigned int tag, size_t n);
+void *aloca_zerada_memoria(unsigned int tag, size_t k, size_t n);
+void *realoca_memoria(unsigned int tag, void *p, size_t n);
+void libera_memoria(void *p);
+#endif
+
+//------------------------------------------------------------------------------
+// Calcula um emparelhamento maximo da componente i (sequencialmente), usando
+// marcas a partir de marca e respeitando o que ja esta em par[]. Componentes
+// ainda livres em que um dos lados tem um vertice so (estrelas, arestas
+// soltas) sao resolvidas direto.
+void emparelha_componente(struct componentes *c, unsigned int i, unsigned int marca);
+
+//------------------------------------------------------------------------------
+// Thread da fase de componentes grandes: faz buscas a partir dos vertices
+// livres ainda nao tentados nesta fase.
+void *thread_componente_grande(void *arg);
+
+//------------------------------------------------------------------------------
+// Thread da fase de componentes pequenas: resolve as tarefas da propria fila
+// e, quando ela acaba, rouba das outras.
+void *thread_componentes(void *arg);
+
+//------------------------------------------------------------------------------
+// Compara tamanhos de componentes (pra ordenar da maior pra menor).
+int compara_componentes(const void *a, const void *b);
+
+//------------------------------------------------------------------------------
+// Estado do emparelhamento em passadas sobre um arquivo de arestas: so
+// vetores por vertice, nada por aresta. Nome[x] = nome do vertice x, achado
+// pela tabela de espalhamento (enderecamento aberto, NENHUM = vazio).
+// Uf/paridade = union-find com a paridade de cada vertice em relacao ao pai,
+// que da os lados. Nivel (lado 0) e pai (lado 1) = floresta da busca em
+// largura, feita uma camada por passada; fins = vertices livres do lado 1
+// alcancados; usado = fase em que o vertice entrou num caminho aumentado.
+struct passadas {
+    char (*nome)[TAM_NOME];
+    unsigned int *tabela, *par, *uf, *nivel, *pai, *fins, *usado;
+    unsigned char *paridade;
+    unsigned int n, capacidade, tam_tabela, padding;
+};
+
+//------------------------------------------------------------------------------
+// Le a proxima aresta ("u v" ou "u -- v" por linha; linhas vazias ou
+// comecadas por # sao ignoradas) de f para u e v. Devolve 0 no fim do
+// arquivo.
+int le_aresta_passadas(FILE *f, char *u, char *v);
+
+//------------------------------------------------------------------------------
+// Devolve o indice do vertice chamado nome em p; se nao existe e cria eh
+// verdadeiro, cria o vertice. Devolve NENHUM se nao existe (ou em caso de
+// erro ao criar).
+unsigned int id_passadas(struct passadas *p, const char *nome, int cria);
+
+//------------------------------------------------------------------------------
+// Devolve a raiz de x no union-find de p, guardando em *paridade a paridade
+// de x em relacao a ela.
+unsigned int raiz_passadas(struct passadas *p, unsigned int x, unsigned char *paridade);
+
+//------------------------------------------------------------------------------
+// Libera os vetores de p.
+void libera_passadas(struct passadas *p);
+
+//------------------------------------------------------------------------------
+// Inicia p vazio. Devolve 0 em caso de erro.
+int inicia_passadas(struct passadas *p);
+
+//------------------------------------------------------------------------------
+// Le as arestas de f (do ponto atual), numerando os vertices e juntando-os
+// no union-find de p; com guloso, monta tambem um emparelhamento maximal.
+// Devolve 1 se o grafo eh bipartido, 0 se nao eh e -1 em caso de erro.
+int le_lados_passadas(struct passadas *p, FILE *f, int guloso);
+
+//------------------------------------------------------------------------------
+// Aloca a floresta de busca de p e guarda o lado de cada vertice em
+// p->paridade. Devolve 0 em caso de erro.
+int prepara_camadas_passadas(struct passadas *p);
+
+//------------------------------------------------------------------------------
+// Comeca uma fase em p: os vertices livres do lado 0 ficam na camada 0.
+void inicia_fase_passadas(struct passadas *p);
+
+//------------------------------------------------------------------------------
+// Trata o arco de l (lado 0) pra r na camada d da busca em largura de p:
+// se l esta na camada d e r ainda nao foi alcancado, r entra na floresta,
+// e seu par na camada d+1 (*novos conta) ou em p->fins (*n_fins conta).
+void expande_passadas(struct passadas *p, unsigned int l, unsigned int r, unsigned int d,
+                      unsigned int *n_fins, unsigned int *novos);
+
+//------------------------------------------------------------------------------
+// Aumenta o emparelhamento de p pelos caminhos da floresta que terminam em
+// p->fins[0 .. n_fins) e nao se cruzam (fase marca os ja usados).
+void aumenta_passadas(struct passadas *p, unsigned int n_fins, unsigned int fase);
+
+//------------------------------------------------------------------------------
+// Devolve um grafo com os vertices emparelhados por par[0 .. n) e as arestas
+// entre eles; o nome do vertice x esta em nomes + x*TAM_NOME.
+grafo grafo_pares(unsigned int n, const unsigned int *par, const char *nomes);
+
+//------------------------------------------------------------------------------
+// Fases de Hopcroft-Karp sobre c (com par[] ja iniciado), ate o maximo ou ate
+// garantir a razao 1 - epsilon. Devolve a razao garantida.
+double hopcroft_karp(struct componentes *c, double epsilon);
+
+//------------------------------------------------------------------------------
+// Grafo em disco, mapeado em memoria. O arquivo tem um cabecalho, ini
+// (n + 1 unsigned int), lado (n bytes), nome (n * TAM_NOME bytes) e adj
+// (ini[n] unsigned int, alinhada em PAGINA_EXTERNO), com os vertices
+// numerados na ordem de uma busca em largura, pra que vizinhos fiquem perto
+// uns dos outros no arquivo.
+struct grafo_externo {
+    unsigned char *mapa;
+    size_t tamanho;
+    unsigned int *ini, *adj;
+    unsigned char *lado;
+    const char *nome;
+    unsigned int n, bipartido;
+    int fd, padding;
+};
+
+//------------------------------------------------------------------------------
+// Cabecalho do arquivo do grafo externo.
+struct cabecalho_externo {
+    char magica[8];
+    unsigned int n, arcos, bipartido, padding;
+};
+
+//------------------------------------------------------------------------------
+// Calcula o deslocamento de cada parte do arquivo de um grafo externo com n
+// vertices e arcos arcos: desl[0] = ini, desl[1] = lado, desl[2] = nome,
+// desl[3] = adj, desl[4] = tamanho total.
+void desloca_externo(unsigned int n, unsigned int arcos, size_t *desl);
+
+//------------------------------------------------------------------------------
+// Transporte local do emparelhamento distribuido: fd[i] = socket ligado a
+// parte i (processo pid[i]); do lado da parte, n = 1 e fd[0] eh o coordenador.
+struct transporte_local {
+    int *fd;
+    pid_t *pid;
+    unsigned int n, padding;
+};
+
+//------------------------------------------------------------------------------
+// Envia/recebe pelo socket da parte (ver transporte).
+int envia_local(transporte *t, unsigned int parte, const unsigned int *dados, unsigned int n);
+int recebe_local(transporte *t, unsigned int parte, unsigned int *dados, unsigned int n);
+
+//------------------------------------------------------------------------------
+// Cria n_partes processos executando trabalhador_emparelhamento() e devolve
+// em t o transporte do coordenador. Devolve 0 em caso de erro.
+int cria_transporte_local(transporte *t, unsigned int n_partes);
+
+//------------------------------------------------------------------------------
+// Fecha os sockets de t e espera os processos das partes.
+void fecha_transporte_local(transporte *t);
+
+//------------------------------------------------------------------------------
+// Envia a mensagem (tipo, n, dados[0 .. n)) pra parte. Devolve 0 em caso de
+// erro.
+int envia_mensagem(transporte *t, unsigned int parte, unsigned int tipo, const unsigned int *dados, unsigned int n);
+
+//------------------------------------------------------------------------------
+// Recebe uma mensagem da parte em *dados (com *cap inteiros, aumentado se
+// preciso) e guarda o tipo em *tipo. Devolve o numero de inteiros ou NENHUM
+// em caso de erro.
+unsigned int recebe_mensagem(transporte *t, unsigned int parte, unsigned int *tipo, unsigned int **dados, unsigned int *cap);
+
+//------------------------------------------------------------------------------
+// Resultado guardado no cache (no arquivo do cache, o registro eh seguido dos
+// dados da entrada). Hash, n e m = hash canonico, numero de vertices e de
+// arestas do grafo (n e m descartam a maioria das colisoes do hash). Tipo =
+// CACHE_*. Valor = veredito de cordal, ou 0 se o grafo nao eh bipartido no
+// emparelhamento. Os dados sao n_nomes nomes de vertices terminados em '\0'
+// (tam_nomes bytes) e n_pares arestas entre eles.
+struct registro_cache {
+    unsigned long long hash;
+    unsigned int n, m, tipo, valor, n_nomes, n_pares, tam_nomes, padding;
+};
+
+//------------------------------------------------------------------------------
+// Entrada do cache, alocada num bloco so com os dados: pesos[i] eh o peso da
+// aresta entre os vertices pares[2i] e pares[2i+1] (indices em nomes).
+// Mais_nova e mais_velha = vizinhas na lista do uso mais recente (LRU).
+// Refs = consultas que leem a entrada sem a trava; uma entrada descartada
+// (removida) com refs > 0 eh liberada pela ultima delas (ver solta_cache).
+struct entrada_cache {
+    struct registro_cache r;
+    long int *pesos;
+    unsigned int *pares;
+    char *nomes;
+    struct entrada_cache *prox, *mais_nova, *mais_velha;
+    unsigned int refs;
+    int removida;
+};
+
+//------------------------------------------------------------------------------
+// Cache de resultados: tabela com tam listas de entradas (indexada pelo
+// hash), e o arquivo onde as entradas novas sao acrescentadas (ou NULL).
+// Nova e velha = pontas da lista LRU. Bytes = memoria das n entradas, que
+// nao passa de limite (as menos usadas recentemente sao descartadas).
+struct cache_grafo {
+    struct entrada_cache **balde;
+    FILE *arquivo;
+    pthread_mutex_t trava;
+    struct entrada_cache *nova, *velha;
+    size_t bytes, limite;
+    unsigned int tam, n, acertos, faltas;
+};
+
+//------------------------------------------------------------------------------
+// Embaralha os bits de x (finalizador do splitmix64).
+unsigned long long mistura_hash(unsigned long long x);
+
+//------------------------------------------------------------------------------
+// Devolve o hash do nome de um vertice.
+unsigned long long hash_nome(const char *nome);
+
+//------------------------------------------------------------------------------
+// Devolve uma tabela de espalhamento com os vertices de g, com *tam
+// (potencia de 2) posicoes, ou NULL em caso de erro.
+vertice *tabela_nomes(grafo g, unsigned int *tam);
+
+//------------------------------------------------------------------------------
+// Devolve o vertice de nome nome na tabela, ou NULL se nao existir.
+vertice procura_tabela_nomes(vertice *tabela, unsigned int tam, const char *nome);
+
+//------------------------------------------------------------------------------
+// Tamanho em bytes dos dados de uma entrada com o registro r.
+size_t dados_cache(const struct registro_cache *r);
+
+//------------------------------------------------------------------------------
+// Aloca uma entrada com o registro r e espaco pros dados. Devolve NULL em
+// caso de erro.
+struct entrada_cache *nova_entrada_cache(const struct registro_cache *r);
+
+//------------------------------------------------------------------------------
+// Devolve 1 se os dados lidos de e (do arquivo do cache) sao consistentes:
+// n_nomes nomes terminados em '\0' com menos de TAM_NOME bytes ocupando
+// tam_nomes bytes, e pares com indices menores que n_nomes. Devolve 0 caso
+// contrario.
+int valida_entrada_cache(const struct entrada_cache *e);
+
+//------------------------------------------------------------------------------
+// Bytes de memoria ocupados pela entrada e.
+size_t tamanho_entrada_cache(const struct entrada_cache *e);
+
+//------------------------------------------------------------------------------
+// Devolve a entrada do tipo dado de g em c, ou NULL, e a passa pra frente da
+// lista LRU. Supoe que o hash de g ja foi calculado e que a trava de c esta
+// com quem chamou.
+struct entrada_cache *procura_cache(cache_grafo c, grafo g, unsigned int tipo);
+
+//------------------------------------------------------------------------------
+// Tira a entrada e da tabela e da lista LRU de c e a libera, ou deixa pra
+// solta_cache se alguem esta lendo. Supoe que a trava de c esta com quem
+// chamou.
+void descarta_cache(cache_grafo c, struct entrada_cache *e);
+
+//------------------------------------------------------------------------------
+// Devolve a referencia a e obtida (com ++e->refs, sob a trava) por uma
+// consulta que leu e sem a trava.
+void solta_cache(cache_grafo c, struct entrada_cache *e);
+
+//------------------------------------------------------------------------------
+// Insere a entrada e em c (ou a desaloca, se outra thread ja inseriu o mesmo
+// resultado), descarta as menos usadas ate caber no limite e, se grava,
+// acrescenta e no arquivo de c. Supoe que a trava de c esta com quem chamou.
+void guarda_cache(cache_grafo c, struct entrada_cache *e, int grava);
+
+//------------------------------------------------------------------------------
+// Guarda em c o resultado do tipo dado de g, que eh o grafo emp ou a lista
+// de vertices l (um dos dois eh NULL; os dois sao NULL se so o valor
+// importa).
+void guarda_resultado_cache(cache_grafo c, grafo g, unsigned int tipo, unsigned int valor, grafo emp, lista l);
+
+//------------------------------------------------------------------------------
+// Guarda em nome[i] o i-esimo nome de e. Devolve nome.
+char **nomes_cache(struct entrada_cache *e, char **nome);
+
+//------------------------------------------------------------------------------
+// Pede ao sistema que traga pra memoria as paginas da adjacencia dos n
+// vertices de fila (juntando paginas vizinhas num pedido so). Se o sistema
+// recusa, avisa e poe c->externo = 2, pra nao pedir mais.
+void antecipa_externo(struct componentes *c, const unsigned int *fila, unsigned int n);
+
+//------------------------------------------------------------------------------
+// Inicia uma nova busca em m, devolvendo a marca "em andamento" (a de
+// finalizado eh ela + 1).
+unsigned int nova_fase_murty(struct murty *m);
+
+//------------------------------------------------------------------------------
+// Relaxa o no y de m com distancia d vindo de pred p.
+void relaxa_murty(struct murty *m, unsigned int y, long int d, unsigned int p);
+
+//------------------------------------------------------------------------------
+// Atribui a linha livre r por um caminho aumentante de custo minimo ate o
+// sorvedouro, atualizando os potenciais. Devolve 0 se nao existe caminho.
+int aumenta_murty(struct murty *m, unsigned int r);
+
+//------------------------------------------------------------------------------
+// Restaura a otimalidade da atribuicao parcial depois que a coluna c foi
+// liberada: procura (a partir do sorvedouro) o ciclo negativo que leva alguma
+// linha pra c e, se houver, aplica, atualizando os potenciais.
+void repara_murty(struct murty *m, unsigned int c);
+
+//------------------------------------------------------------------------------
+// Resolve o subproblema s de nos partindo da solucao e dos potenciais do pai.
+// Devolve 1 se o subproblema tem solucao, ou 0 caso contrario.
+int resolve_murty(struct murty *m, struct sub_murty *nos, struct sub_murty *s);
+
+//------------------------------------------------------------------------------
+// Devolve a aresta entre u e v (em qualquer direcao), ou NULL se nao existir.
+aresta procura_aresta(vertice u, vertice v);
+
+//------------------------------------------------------------------------------
+// Remove a aresta a de g (das listas dos seus vertices) e a desaloca em O(1).
+void remove_aresta(grafo g, aresta a);
+
+//------------------------------------------------------------------------------
+// Devolve o arco de u para v, ou NULL se nao existir. Percorre a menor das
+// listas u->saida e v->entrada.
+aresta procura_arco(vertice u, vertice v);
+
+//------------------------------------------------------------------------------
+// Reserva n marcas novas em g e devolve a primeira delas. As marcas m, m+1,
+// ..., m+n-1 podem ser usadas em v->marca sem resetar os vertices, porque
+// todo vertice que nao foi marcado depois desta chamada tem marca < m.
+unsigned int proxima_marca(grafo g, unsigned int n);
+
+//------------------------------------------------------------------------------
+// Devolve a lista dos vizinhos comuns de u e v, que ficam marcados com a
+// marca devolvida em *m.
+lista vizinhos_comuns(grafo g, vertice u, vertice v, unsigned int *m);
+
+//------------------------------------------------------------------------------
+// Devolve 1 se u e v estao ligados por um caminho que nao passa por vertices
+// de marca m_bloq, ou 0 caso contrario. Faz duas buscas em profundidade
+// simultaneas, uma a partir de u e outra a partir de v, e para assim que uma
+// delas acaba; logo o tempo eh proporcional ao menor dos dois lados.
+int alcanca_evitando(grafo g, vertice u, vertice v, unsigned int m_bloq);
+
+//------------------------------------------------------------------------------
+// Cliques de um grafo cordal calculadas a partir de uma OPE.
+// Clique = vetor com as listas de vertices de cada clique maximal.
+// Pai = indice da clique pai na arvore de cliques (-1 se for raiz).
+// Separador = tamanho da intersecao entre a clique e a clique pai.
+// N = numero de cliques.
+struct cliques_ope {
+    lista *clique;
+    int *pai;
+    unsigned int *separador;
+    unsigned int n, padding;
+};
+
+//------------------------------------------------------------------------------
+// Guarda em v->atributo a posicao de cada vertice v na ordem e devolve um
+// vetor com os vertices indexados por essa posicao.
+vertice *numera_ordem(lista ordem);
+
+//------------------------------------------------------------------------------
+// Devolve o vizinho de v que aparece primeiro na ordem dentre os que aparecem
+// depois de v (ou NULL se nao houver nenhum) e guarda em *n_sucessores
+// quantos vizinhos de v aparecem depois dele. Supoe que numera_ordem() ja
+// foi chamada.
+vertice sucessor_ope(vertice v, unsigned int *n_sucessores);
+
+//------------------------------------------------------------------------------
+// Insere em l o vertice v e todos os seus vizinhos que aparecem depois dele
+// na ordem. Supoe que numera_ordem() ja foi chamada.
+void insere_sucessores(vertice v, lista l);
+
+//------------------------------------------------------------------------------
+// Calcula as cliques maximais e a arvore de cliques de um grafo cordal a
+// partir de uma OPE. Devolve NULL em caso de erro.
+struct cliques_ope *calcula_cliques(lista ordem);
+
+//------------------------------------------------------------------------------
+// Desaloca a estrutura c. Se destroi_cliques != 0, desaloca tambem as listas
+// das cliques.
+void destroi_cliques_ope(struct cliques_ope *c, int destroi_cliques);
+
 //------------------------------------------------------------------------------
 // Retorna 1 se a aresta estiver coberta, 0 caso contrario.
 int aresta_coberta(aresta a);
@@ -211,11 +984,33 @@ void xor(lista l);
 //------------------------------------------------------------------------------
 // Função recursiva que busca um camminho aumentante. Caso eles eja encontrado,
 // retorna 1 e o caminho aumentante é representado por uma lista de arestas em l.
-int busca_caminho(vertice v, lista l, int last);
+// Os vertices visitados sao os que tem marca m. O caminho tem no maximo
+// limite arestas (SEM_LIMITE para nao limitar); com limite, a busca pode nao
+// achar um caminho curto que passe por um vertice ja visitado mais fundo.
+int busca_caminho(vertice v, lista l, int last, unsigned int m, unsigned int limite);
+
+//------------------------------------------------------------------------------
+// Calcula um emparelhamento maximo do grafo bipartido g, cujos lados ja foram
+// calculados por bipartido(), deixando-o marcado nos atributos coberta das
+// arestas e coberto dos vertices. Devolve o tamanho dele.
+unsigned int emparelha(grafo g);
 
 //------------------------------------------------------------------------------
-// Procura um caminho aumentante (se existir) no grafo g.
-lista caminho_aumentante(grafo g);
+// Devolve um grafo com copias das arestas cobertas de g e dos seus vertices.
+grafo grafo_emparelhamento(grafo g);
+
+//------------------------------------------------------------------------------
+// Procura um caminho aumentante com no maximo limite arestas que comece no
+// vertice livre v e, se achar, aumenta o emparelhamento com ele. Devolve 1 se
+// aumentou, 0 caso contrario.
+int aumenta_a_partir_de(grafo g, vertice v, unsigned int limite);
+
+//------------------------------------------------------------------------------
+// Procura um caminho aumentante que passe pela aresta descoberta a (o unico
+// tipo de caminho aumentante que pode surgir quando a eh inserida num grafo
+// cujo emparelhamento era maximo) e, se achar, aumenta o emparelhamento com
+// ele. Devolve 1 se aumentou, 0 caso contrario.
+int aumenta_por_aresta(grafo g, aresta a);
 
 //------------------------------------------------------------------------------
 // Implementação das Funções:
@@ -265,7 +1060,7 @@ no proximo_no(no n) { return n->proximo; }
 
 lista constroi_lista(void) {
 
-  lista l = malloc(sizeof(struct lista));
+  lista l = ALOCA(MEM_LISTAS, sizeof(struct lista));
 
   if ( ! l ) 
     return NULL;
@@ -299,13 +1094,18 @@ int destroi_lista(lista l, int destroi(void *)) {
     if ( destroi )
       ok &= destroi(conteudo(p));
 
-    free(p);
+    LIBERA(p);
   }
 
-  free(l);
+  LIBERA(l);
 
   return ok;
 }
+//---------------------------------------------------------------------------
+// desaloca a lista l e todos os seus nós, mas não o conteúdo deles
+
+int destroi_sublista(void *l) { return destroi_lista((lista) l, NULL); }
+
 //---------------------------------------------------------------------------
 // insere um novo nó na lista l cujo conteúdo é p
 //
@@ -314,13 +1114,16 @@ int destroi_lista(lista l, int destroi(void *)) {
 
 no insere_lista(void *conteudo, lista l) {
 
-  no novo = malloc(sizeof(struct no));
+  no novo = ALOCA(MEM_LISTAS, sizeof(struct no));
 
   if ( ! novo )
     return NULL;
 
   novo->conteudo = conteudo;
   novo->proximo = primeiro_no(l);
+  novo->anterior = NULL;
+  if ( novo->proximo )
+    novo->proximo->anterior = novo;
   ++l->tamanho;
 
   return l->primeiro = novo;
@@ -328,30 +1131,27 @@ no insere_lista(void *conteudo, lista l) {
 
 //------------------------------------------------------------------------------
 // Remove um nó de uma lista e executa a função destroi no conteúdo de cada nó.
+// Como a lista é duplamente encadeada, o tempo é O(1).
 
 int remove_no(struct lista *l, struct no *rno, int destroi(void *)) {
     int r = 1;
-    if (l->primeiro == rno) {
+    if (rno == NULL || (rno->anterior == NULL && l->primeiro != rno)) {
+        return 0;
+    }
+    if (rno->anterior) {
+        rno->anterior->proximo = rno->proximo;
+    } else {
         l->primeiro = rno->proximo;
-        if (destroi != NULL) {
-            r = destroi(conteudo(rno));
-        }
-        free(rno);
-        l->tamanho--;
-        return r;
-    }
-    for (no n = primeiro_no(l); n->proximo; n = proximo_no(n)) {
-        if (n->proximo == rno) {
-            n->proximo = rno->proximo;
-            if (destroi != NULL) {
-                r = destroi(conteudo(rno));
-            }
-            free(rno);
-            l->tamanho--;
-            return r;
-        }
     }
-    return 0;
+    if (rno->proximo) {
+        rno->proximo->anterior = rno->anterior;
+    }
+    if (destroi != NULL) {
+        r = destroi(conteudo(rno));
+    }
+    LIBERA(rno);
+    l->tamanho--;
+    return r;
 }
 
 
@@ -374,24 +1174,27 @@ int na_lista(lista l, void* content) {
 
 grafo constroi_grafo(void) {
     grafo g;
-    g = (grafo) malloc(sizeof(struct grafo));
+    g = (grafo) ALOCA(MEM_GRAFO, sizeof(struct grafo));
     if(g == NULL) {
         perror("(constroi_grafo) Erro ao allocar memoria para o grafo.");
         return NULL;
     }
     g->v = constroi_lista();
-    g->nome = malloc(sizeof(char) * TAM_NOME);
+    g->nome = ALOCA(MEM_GRAFO, sizeof(char) * TAM_NOME);
     if(g->nome == NULL) {
         perror("(constroi_grafo) Erro ao allocar memoria para nome.");
         return NULL;
     }
     g->direcao = 0;
     g->ponderado = 0;
+    g->marca = 0;
+    g->n_arestas = 0;
+    g->hash = 0;
     return g;
 }
 
 vertice constroi_vertice(void) {
-    vertice v = malloc(sizeof(struct vertice));
+    vertice v = ALOCA(MEM_GRAFO, sizeof(struct vertice));
     if(v == NULL) {
         perror("(constroi_vertice) Erro ao allocar memoria para o vertice.");
         return NULL;
@@ -400,16 +1203,17 @@ vertice constroi_vertice(void) {
         puts("Erro ao construir lista de saida.");
     if(!(v->entrada = constroi_lista()))
         puts("Erro ao construir lista de saida.");
-    v->nome = malloc(sizeof(char) * TAM_NOME);
+    v->nome = ALOCA(MEM_GRAFO, sizeof(char) * TAM_NOME);
     if(v->nome == NULL) {
         perror("(constroi_vertice) Erro ao allocar memoria para nome.");
         return NULL;
     }
+    v->marca = 0;
     return v;
 }
 
 aresta constroi_aresta(void) {
-    aresta a = malloc(sizeof(struct aresta));
+    aresta a = ALOCA(MEM_GRAFO, sizeof(struct aresta));
     if(a == NULL) {
         perror("(constroi_aresta) Erro ao allocar memoria para aresta.");
         return NULL;
@@ -433,7 +1237,7 @@ int destroi_aresta(void* param) {
     // Destroi_aresta soh destroi a propria aresta.
     aresta a = (aresta) param;
     if(a == NULL) return 1; // Jah foi destruido
-    free(a);
+    LIBERA(a);
     return 1;
 }
 
@@ -443,7 +1247,7 @@ int destroi_vertice(void* param) { // Soh funciona pra ser chamado dentro de des
         return 1; // Jah foi destruido
     }
     if(v->nome) {
-        free(v->nome);
+        LIBERA(v->nome);
     }
     if(!destroi_lista(v->saida, destroi_aresta)) {
         perror("(destroi_vertice) Erro ao destruir lista.");
@@ -453,7 +1257,7 @@ int destroi_vertice(void* param) { // Soh funciona pra ser chamado dentro de des
         perror("(destroi_vertice) Erro ao destruir lista.");
         return 0;
     }
-    free(v);
+    LIBERA(v);
     return 1;
 }
 
@@ -462,7 +1266,7 @@ int destroi_grafo(void* param) {
     if(g == NULL)
         return 1;
     if(g->nome) {
-        free(g->nome);
+        LIBERA(g->nome);
     }
 
     if(!destroi_lista(g->v, destroi_vertice)) {
@@ -470,7 +1274,7 @@ int destroi_grafo(void* param) {
         return 0;
     }
 
-    free(g);
+    LIBERA(g);
     return 1;
 }
 
@@ -483,24 +1287,32 @@ vertice insere_vertice(grafo g, char* nome) {
     }
     vertice v = conteudo(novo);
     v->nome = strncpy(v->nome,nome,TAM_NOME);
+    v->no_grafo = novo;
+    g->hash = 0;
     return v;
 }
 
-aresta insere_aresta(vertice saida, vertice chegada, long int peso) {
+aresta insere_aresta(grafo g, vertice saida, vertice chegada, long int peso) {
     aresta a = constroi_aresta();
     a->vs = saida;
     a->vc = chegada;
     a->peso = peso;
+    return liga_aresta(g, a);
+}
+
+aresta liga_aresta(grafo g, aresta a) {
     // Insere a aresta na lista de arestas do vertice de saida
-    if(insere_lista((void*)a, saida->saida) == NULL) {
-        perror("(insere_aresta) Erro ao inserir aresta no vertice.");
+    if((a->no_saida = insere_lista((void*)a, a->vs->saida)) == NULL) {
+        perror("(liga_aresta) Erro ao inserir aresta no vertice.");
         return NULL;
     }
     // Insere a aresta na lista de arestas do vertice de chegada
-    if(insere_lista((void*)a, chegada->entrada) == NULL) {
-        perror("(insere_aresta) Erro ao inserir aresta no vertice.");
+    if((a->no_entrada = insere_lista((void*)a, a->vc->entrada)) == NULL) {
+        perror("(liga_aresta) Erro ao inserir aresta no vertice.");
         return NULL;
     }
+    ++g->n_arestas;
+    g->hash = 0;
     return a;
 }
 
@@ -545,8 +1357,7 @@ vertice copia_vertice(vertice v) {
 
 grafo copia_grafo(grafo g) {
     no elem, childElem;
-    void* content;
-    vertice v;
+    vertice v, copia;
 
     grafo g2 = constroi_grafo();
 
@@ -556,8 +1367,8 @@ grafo copia_grafo(grafo g) {
 
     // Copia vertices
     for(elem = primeiro_no(g->v); elem; elem = proximo_no(elem)) {
-        content = (void*) copia_vertice(conteudo(elem));
-        if(insere_lista(content, g2->v) == NULL) {
+        copia = copia_vertice(conteudo(elem));
+        if((copia->no_grafo = insere_lista(copia, g2->v)) == NULL) {
             perror("(copia_grafo) Erro ao inserir vertice no grafo copia.");
             return NULL;
         }
@@ -569,12 +1380,7 @@ grafo copia_grafo(grafo g) {
         // ... pra percorrer todas as arestas
         for(childElem = primeiro_no(v->saida); childElem; childElem = proximo_no(childElem)) {
             // cria uma aresta nova e insere no grafo novo
-            content = (void*) copia_aresta(conteudo(childElem), g2);
-            if(insere_lista(content, ((aresta)content)->vc->saida) == NULL) {
-                perror("(copia_grafo) Erro ao inserir aresta no vertice copia.");
-                return NULL;
-            }
-            if(insere_lista(content, ((aresta)content)->vs->entrada) == NULL) {
+            if(liga_aresta(g2, copia_aresta(conteudo(childElem), g2)) == NULL) {
                 perror("(copia_grafo) Erro ao inserir aresta no vertice copia.");
                 return NULL;
             }
@@ -586,9 +1392,8 @@ grafo copia_grafo(grafo g) {
 
 grafo copia_subgrafo(grafo g, lista excecoes) {
     no elem, childElem;
-    void* content;
     aresta a;
-    vertice v;
+    vertice v, copia;
 
     grafo g2 = constroi_grafo();
 
@@ -601,8 +1406,8 @@ grafo copia_subgrafo(grafo g, lista excecoes) {
         if(na_lista(excecoes, conteudo(elem))) {
             continue;
         }
-        content = (void*) copia_vertice(conteudo(elem));
-        if(insere_lista(content, g2->v) == NULL) {
+        copia = copia_vertice(conteudo(elem));
+        if((copia->no_grafo = insere_lista(copia, g2->v)) == NULL) {
             perror("(copia_grafo) Erro ao inserir vertice no grafo copia.");
             return NULL;
         }
@@ -619,12 +1424,7 @@ grafo copia_subgrafo(grafo g, lista excecoes) {
                 continue;
             }
             // Cria uma aresta nova e insere no grafo novo
-            content = (void*) copia_aresta(conteudo(childElem), g2);
-            if(insere_lista(content, ((aresta)content)->vc->entrada) == NULL) {
-                perror("(copia_grafo) Erro ao inserir aresta no vertice copia.");
-                return NULL;
-            }
-            if(insere_lista(content, ((aresta)content)->vs->saida) == NULL) {
+            if(liga_aresta(g2, copia_aresta(a, g2)) == NULL) {
                 perror("(copia_grafo) Erro ao inserir aresta no vertice copia.");
                 return NULL;
             }
@@ -642,6 +1442,10 @@ char* nome_grafo(grafo g) {
     return g->nome;
 }
 
+char* nome_vertice(vertice v) {
+    return v->nome;
+}
+
 int direcionado(grafo g) {
     return g->direcao;
 }
@@ -654,31 +1458,13 @@ unsigned int grau(vertice v, int direcao, grafo g) {
     if(g == NULL) {
         return 0;
     }
-    no elem;
-    aresta a;
-    unsigned int count = 0;
     switch (direcao) {
         case -1:
-            for(elem = primeiro_no(v->entrada); elem; elem = proximo_no(elem)) {
-                a = (aresta) conteudo(elem);
-                if(a->vs == v)
-                    ++count;
-            }
-            return count;
-            break;
-        case 0:
-            return (unsigned int) 2 * tamanho_lista(v->entrada);
-            break;
+            return tamanho_lista(v->entrada);
         case 1:
-            for(elem = primeiro_no(v->entrada); elem; elem = proximo_no(elem)) {
-                a = (aresta) conteudo(elem);
-                if(a->vc == v)
-                    ++count;
-            }
-            return count;
-            break;
+            return tamanho_lista(v->saida);
     }
-    return count;
+    return tamanho_lista(v->entrada) + tamanho_lista(v->saida);
 }
 
 unsigned int n_vertices(grafo g) {
@@ -686,14 +1472,38 @@ unsigned int n_vertices(grafo g) {
 }
 
 unsigned int n_arestas(grafo g) {
-    unsigned int count = 0;
-    no elem;
-    vertice v;
-    for(elem = primeiro_no(g->v); elem; elem = proximo_no(elem)) {
-        v = (vertice) conteudo(elem);
-        count += tamanho_lista(v->entrada);
+    return g->n_arestas;
+}
+
+void inicia_vizinhanca(cursor_vizinhanca *c, vertice v, int direcao) {
+    c->v = v;
+    c->direcao = direcao;
+    // Comeca pela saida, a nao ser que so a vizinhanca de entrada interesse.
+    c->fase = direcao >= 0 ? VIZIN_SAIDA : VIZIN_ENTRA;
+    c->atual = primeiro_no(direcao >= 0 ? v->saida : v->entrada);
+}
+
+aresta proxima_incidente(cursor_vizinhanca *c) {
+    aresta a;
+
+    if(!c->atual && c->fase == VIZIN_SAIDA && c->direcao == VIZIN_COMPL) {
+        // Acabou a saida de um vertice de grafo nao direcionado: passa pra entrada.
+        c->fase = VIZIN_ENTRA;
+        c->atual = primeiro_no(c->v->entrada);
     }
-    return count;
+    if(!c->atual)
+        return NULL;
+    a = (aresta) conteudo(c->atual);
+    c->atual = proximo_no(c->atual);
+    return a;
+}
+
+vertice proximo_vizinho(cursor_vizinhanca *c) {
+    aresta a = proxima_incidente(c);
+
+    if(!a)
+        return NULL;
+    return c->fase == VIZIN_SAIDA ? a->vc : a->vs;
 }
 
 lista vizinhanca(vertice v, int direcao, grafo g) {
@@ -701,25 +1511,13 @@ lista vizinhanca(vertice v, int direcao, grafo g) {
         return NULL;
     }
     lista l = constroi_lista();
-    no elem;
-    aresta a;
+    cursor_vizinhanca c;
+    vertice w;
 
-    if(direcao >= 0) {
-        for(elem = primeiro_no(v->saida); elem; elem = proximo_no(elem)) {
-            a = (aresta) conteudo(elem);
-            if(insere_lista((void*)a->vc, l) == NULL) {
-                perror("(vizinhanca) Erro ao inserir vertice na lista de vizinhanca de saida");
-                return NULL;
-            }
-        }
-    }
-    if(direcao <= 0) {
-        for(elem = primeiro_no(v->entrada); elem; elem = proximo_no(elem)) {
-            a = (aresta) conteudo(elem);
-            if(insere_lista((void*)a->vs, l) == NULL) {
-                perror("(vizinhanca) Erro ao inserir vertice na lista de vizinhanca de saida");
-                return NULL;
-            }
+    for(inicia_vizinhanca(&c, v, direcao); (w = proximo_vizinho(&c)); ) {
+        if(insere_lista((void*)w, l) == NULL) {
+            perror("(vizinhanca) Erro ao inserir vertice na lista de vizinhanca");
+            return NULL;
         }
     }
     return l;
@@ -821,6 +1619,7 @@ int cordal(grafo g) {
 int lexcmp(int *a, int *b) {
 /* Retorna positivo se b > a */
     int i = 0;
+    CONTA(comparacoes_rotulo, 1);
     while (a[i] != FDR && b[i] != FDR) {
         if(a[i] - b[i] == 0) {
             ++i;
@@ -865,12 +1664,13 @@ lista busca_largura_lexicografica(grafo g) {
     no elem;
     vertice v;
     unsigned int tamanho;
+    INICIA_FASE(t);
     // Para cada v em V(G)
     for(elem = primeiro_no(g->v); elem; elem = proximo_no(elem)) {
         // Inicialize o rótulo de v com {}
         v = (vertice) conteudo(elem);
         tamanho = tamanho_lista(v->entrada) + tamanho_lista(v->saida) + 1;
-        v->rotulo = malloc(tamanho * sizeof(int));
+        v->rotulo = ALOCA(MEM_ALGORITMOS, tamanho * sizeof(int));
         v->rotulo[0] = FDR;
         v->estado = BRAN;
         v->atributo = 0; // Atributo, nesta funcao, equivale ao tamanho do rotulo.
@@ -896,8 +1696,9 @@ lista busca_largura_lexicografica(grafo g) {
 
     for(elem = primeiro_no(g->v); elem; elem = proximo_no(elem)) {
         v = (vertice) conteudo(elem);
-        free(v->rotulo);
+        LIBERA(v->rotulo);
     }
+    TERMINA_FASE(FASE_LEXICOGRAFICA, t);
     return ordem;
 }
 
@@ -998,7 +1799,8 @@ int ordem_perfeita_eliminacao(lista l, grafo g) {
     no elem, elem2;
     vertice v, w, u;
     aresta a;
-    int i, tam_vizinh, cont;
+    int i, tam_vizinh, cont, ok = 1;
+    INICIA_FASE(t);
 
     // Percorre todos os elementos inicializando estado e atributo.
     for(elem = primeiro_no(g->v); elem; elem = proximo_no(elem)) {
@@ -1044,202 +1846,4532 @@ int ordem_perfeita_eliminacao(lista l, grafo g) {
         for(elem2 = primeiro_no(w->entrada); elem2; elem2 = proximo_no(elem2)) {
             a = (aresta) conteudo(elem2);
             u = a->vs;
-            if(u->atributo == i) {
+            if(u->atributo == i && u->estado == BRAN) {
                 cont++;
             }
         }
         for(elem2 = primeiro_no(w->saida); elem2; elem2 = proximo_no(elem2)) {
             a = (aresta) conteudo(elem2);
             u = a->vc;
-            if(u->atributo == i) {
+            if(u->atributo == i && u->estado == BRAN) {
                 cont++;
             }
         }
 
         // -1 pra desconsiderar o proprio w.
         if(cont < tam_vizinh-1) { // A vizinhança de v nao ta contida em w.
-            return 0;
+            ok = 0;
+            break;
         }
 
         v->estado = AZUL; // 'Remove' elemento do grafo
     }
 
-    return 1;
+    TERMINA_FASE(FASE_OPE, t);
+    return ok;
 }
 
-inline int aresta_coberta(aresta a) {
-    return a->coberta;
+lista ordem_cordal(grafo g) {
+    if(g->direcao)
+        return NULL;
+
+    lista l = busca_largura_lexicografica(g);
+    if(!ordem_perfeita_eliminacao(l,g)) {
+        destroi_lista(l, NULL);
+        return NULL;
+    }
+    return l;
 }
 
-void copia_vertices(grafo g1, grafo g2) {
-    /* Versão criando vértices novos (pois devo mudar a lista de vizinhança dele).
-       Copia os vértices de g2 para g1 (g1 é um grafo vazio no início) */
+vertice *numera_ordem(lista ordem) {
     no elem;
     vertice v;
+    int i;
+    vertice *vetor = ALOCA(MEM_ALGORITMOS, tamanho_lista(ordem) * sizeof(vertice) + 1);
 
-    for(elem = primeiro_no(g2->v); elem; elem = proximo_no(elem)) {
-        // Cria um novo vertice.
+    if(vetor == NULL) {
+        perror("(numera_ordem) Erro ao allocar memoria para o vetor.");
+        return NULL;
+    }
+    for(i=0, elem = primeiro_no(ordem); elem; elem = proximo_no(elem), ++i) {
         v = (vertice) conteudo(elem);
-        if(v->coberto)
-            insere_vertice(g1, v->nome );
+        v->atributo = i;
+        vetor[i] = v;
     }
+    return vetor;
 }
 
-void copia_arestas_cobertas(grafo g1, grafo g2) {
-    /* Copia arestas de g2 cobertas pelo emparalhamento para g1.
-     * A ideia é parecida com a leitura do grafo: eu leio um vértice v
-     * do grafo g2, que é o grafo que tem as arestas, e percorro a sua
-     * vizinhança. Como os vértices do grafo g1 são diferentes dos vértices
-     * de g2, eu tenho que procurar o semelhante a v em g1, que vou salvar
-     * em v_saida. Depois, percorre a vizinhança de v (porque ele tem as
-     * arestas) e acha o vértice de chegada. Com esse vertice de chegada
-     * (a->vc), pego o semelhante a ele em g1, que salvo em v_chegada.
-     * Depois, insiro em g1. */
-    no elem_v, elem_a;
-    vertice v, v_saida, v_chegada;
+vertice sucessor_ope(vertice v, unsigned int *n_sucessores) {
+    no elem;
     aresta a;
+    vertice u, suc = NULL;
 
-    for(elem_v = primeiro_no(g2->v); elem_v; elem_v = proximo_no(elem_v)) {
-        v = (vertice) conteudo(elem_v);
-        v_saida = procura_vertice(g1, v->nome);
-        for(elem_a = primeiro_no(v->saida); elem_a; elem_a = proximo_no(elem_a)) {
-            a = (aresta) conteudo(elem_a);
-            if(aresta_coberta(a)) {
-                v_chegada = procura_vertice(g1, a->vc->nome);
-                insere_aresta(v_saida, v_chegada, a->peso);
-            }
+    *n_sucessores = 0;
+    for(elem = primeiro_no(v->entrada); elem; elem = proximo_no(elem)) {
+        a = (aresta) conteudo(elem);
+        u = a->vs;
+        if(u->atributo > v->atributo) {
+            ++*n_sucessores;
+            if(!suc || u->atributo < suc->atributo)
+                suc = u;
+        }
+    }
+    for(elem = primeiro_no(v->saida); elem; elem = proximo_no(elem)) {
+        a = (aresta) conteudo(elem);
+        u = a->vc;
+        if(u->atributo > v->atributo) {
+            ++*n_sucessores;
+            if(!suc || u->atributo < suc->atributo)
+                suc = u;
         }
     }
+    return suc;
 }
 
-void xor(lista l) {
-/* Usando l como lista de arestas */
-    aresta a;
+void insere_sucessores(vertice v, lista l) {
     no elem;
+    aresta a;
 
-    for(elem = primeiro_no(l); elem; elem = proximo_no(elem)) {
+    insere_lista(v, l);
+    for(elem = primeiro_no(v->entrada); elem; elem = proximo_no(elem)) {
         a = (aresta) conteudo(elem);
-        a->vc->coberto = 1;
-        a->vs->coberto = 1;
-        a->coberta = !a->coberta;
+        if(a->vs->atributo > v->atributo)
+            insere_lista(a->vs, l);
+    }
+    for(elem = primeiro_no(v->saida); elem; elem = proximo_no(elem)) {
+        a = (aresta) conteudo(elem);
+        if(a->vc->atributo > v->atributo)
+            insere_lista(a->vc, l);
     }
 }
 
-int busca_caminho(vertice v, lista l, int last) {
-    /* essa função é chamada pela função que tenta achar um caminho aumentante pra
-     * cada vértice não coberto (e retorna assim que achar) e last é inicialmente 1,
-     * pois a primeira aresta (que tenho que achar) será 0 (não coberta) */
+struct cliques_ope *calcula_cliques(lista ordem) {
+    /* Percorre a OPE de tras pra frente (ou seja, na ordem da busca). Cada
+     * vertice v ou estende a clique do seu sucessor p na OPE (quando os
+     * sucessores de v sao exatamente essa clique), ou comeca uma clique nova
+     * formada por v e seus sucessores, que eh filha da clique de p na arvore.
+     * O indice da clique de cada vertice fica em v->estado. */
+    unsigned int n = tamanho_lista(ordem), m, k;
+    int i;
+    vertice v, p;
+    vertice *vetor = numera_ordem(ordem);
+    struct cliques_ope *c = ALOCA(MEM_ALGORITMOS, sizeof(struct cliques_ope));
+
+    if(vetor == NULL || c == NULL) {
+        perror("(calcula_cliques) Erro ao allocar memoria.");
+        LIBERA(vetor);
+        LIBERA(c);
+        return NULL;
+    }
+    c->n = 0;
+    c->clique = ALOCA(MEM_ALGORITMOS, n * sizeof(lista) + 1);
+    c->pai = ALOCA(MEM_ALGORITMOS, n * sizeof(int) + 1);
+    c->separador = ALOCA(MEM_ALGORITMOS, n * sizeof(unsigned int) + 1);
+    if(!c->clique || !c->pai || !c->separador) {
+        perror("(calcula_cliques) Erro ao allocar memoria.");
+        destroi_cliques_ope(c, 0);
+        LIBERA(vetor);
+        return NULL;
+    }
 
-    if (!v->coberto && !v->visitado) {
-        return TRUE;
+    for(i = (int) n - 1; i >= 0; --i) {
+        v = vetor[i];
+        p = sucessor_ope(v, &m);
+        if(p && m == tamanho_lista(c->clique[p->estado])) {
+            // Os sucessores de v sao a clique de p inteira: v entra nela.
+            insere_lista(v, c->clique[p->estado]);
+            v->estado = p->estado;
+            continue;
+        }
+        k = c->n++;
+        c->clique[k] = constroi_lista();
+        insere_sucessores(v, c->clique[k]);
+        c->pai[k] = p ? p->estado : -1;
+        c->separador[k] = m;
+        v->estado = (int) k;
     }
 
-    no elem;
-    aresta a;
-    vertice w;
+    LIBERA(vetor);
+    return c;
+}
 
-    v->visitado = 1;
+void destroi_cliques_ope(struct cliques_ope *c, int destroi_cliques) {
+    unsigned int i;
 
-    for(elem = primeiro_no(v->saida); elem; elem = proximo_no(elem)) {
-        a = (aresta) conteudo(elem);
-        if(a->coberta != last) {
-            w = a->vc; // w = vizinho do vértice
-            if(!w->visitado && busca_caminho(w, l, !last)) {
-                insere_lista(a, l);
-                return TRUE;
-            }
-        }
+    if(destroi_cliques)
+        for(i = 0; i < c->n; ++i)
+            destroi_lista(c->clique[i], NULL);
+    LIBERA(c->clique);
+    LIBERA(c->pai);
+    LIBERA(c->separador);
+    LIBERA(c);
+}
+
+lista cliques_maximais(lista ordem, grafo g) {
+    if(g == NULL)
+        return NULL;
+
+    struct cliques_ope *c = calcula_cliques(ordem);
+    unsigned int i;
+    lista l;
+
+    if(c == NULL)
+        return NULL;
+    l = constroi_lista();
+    // insere_lista insere no inicio, entao insere de tras pra frente pra que
+    // a i-esima clique fique na posicao i.
+    for(i = c->n; i > 0; --i)
+        insere_lista(c->clique[i-1], l);
+    destroi_cliques_ope(c, 0);
+    return l;
+}
+
+lista clique_maxima(lista ordem, grafo g) {
+    if(g == NULL)
+        return NULL;
+
+    struct cliques_ope *c = calcula_cliques(ordem);
+    unsigned int i, maior = 0;
+    lista l;
+
+    if(c == NULL)
+        return NULL;
+    if(c->n == 0) {
+        destroi_cliques_ope(c, 0);
+        return constroi_lista();
     }
-    for(elem = primeiro_no(v->entrada); elem; elem = proximo_no(elem)) {
-        a = (aresta) conteudo(elem);
-        if(a->coberta != last) {
-            w = a->vs;
-            if(!w->visitado && busca_caminho(w, l, !last)) {
-                insere_lista(a, l);
-                return TRUE;
-            }
-        }
+    for(i = 1; i < c->n; ++i)
+        if(tamanho_lista(c->clique[i]) > tamanho_lista(c->clique[maior]))
+            maior = i;
+    l = c->clique[maior];
+    c->clique[maior] = c->clique[--c->n];
+    destroi_cliques_ope(c, 1);
+    return l;
+}
+
+grafo arvore_cliques(lista ordem, grafo g) {
+    if(g == NULL)
+        return NULL;
+
+    struct cliques_ope *c = calcula_cliques(ordem);
+    unsigned int i;
+    char nome[TAM_NOME];
+    vertice *nos;
+    grafo arvore;
+
+    if(c == NULL)
+        return NULL;
+    nos = ALOCA(MEM_ALGORITMOS, c->n * sizeof(vertice) + 1);
+    if(nos == NULL) {
+        perror("(arvore_cliques) Erro ao allocar memoria.");
+        destroi_cliques_ope(c, 1);
+        return NULL;
     }
 
-    return FALSE;
+    arvore = constroi_grafo();
+    snprintf(arvore->nome, TAM_NOME, "Arvore de Cliques");
+    arvore->ponderado = 1;
+    for(i = c->n; i > 0; --i) {
+        snprintf(nome, TAM_NOME, "%u", i-1);
+        nos[i-1] = insere_vertice(arvore, nome);
+    }
+    // Os pais sempre sao criados antes dos filhos.
+    for(i = 0; i < c->n; ++i)
+        if(c->pai[i] >= 0)
+            insere_aresta(arvore, nos[c->pai[i]], nos[i], (long int) c->separador[i]);
+
+    LIBERA(nos);
+    destroi_cliques_ope(c, 1);
+    return arvore;
 }
 
-lista caminho_aumentante(grafo g) {
-    no elem_v, elem_aux;
+lista coloracao_otima(lista ordem, grafo g) {
+    /* Colore gulosamente na ordem inversa da OPE: os vizinhos ja coloridos de
+     * v sao seus sucessores, que formam uma clique, entao nunca sao usadas
+     * mais cores que o tamanho da clique maxima. A cor fica em v->estado. */
+    if(g == NULL)
+        return NULL;
+
+    unsigned int n = tamanho_lista(ordem), n_cores = 0, cor;
+    int i;
+    no elem;
+    aresta a;
     vertice v;
+    vertice *vetor = numera_ordem(ordem);
+    int *usada = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(int));
+    lista *classe;
     lista l;
 
+    if(vetor == NULL || usada == NULL) {
+        perror("(coloracao_otima) Erro ao allocar memoria.");
+        LIBERA(vetor);
+        LIBERA(usada);
+        return NULL;
+    }
+    for(cor = 0; cor <= n; ++cor)
+        usada[cor] = -1;
 
-    for(elem_v = primeiro_no(g->v); elem_v; elem_v = proximo_no(elem_v)) {
-        v = (vertice) conteudo(elem_v);
-        v->visitado = 0;
+    for(i = (int) n - 1; i >= 0; --i) {
+        v = vetor[i];
+        // Marca com i as cores dos sucessores de v.
+        for(elem = primeiro_no(v->entrada); elem; elem = proximo_no(elem)) {
+            a = (aresta) conteudo(elem);
+            if(a->vs->atributo > i)
+                usada[a->vs->estado] = i;
+        }
+        for(elem = primeiro_no(v->saida); elem; elem = proximo_no(elem)) {
+            a = (aresta) conteudo(elem);
+            if(a->vc->atributo > i)
+                usada[a->vc->estado] = i;
+        }
+        for(cor = 0; usada[cor] == i; ++cor)
+            ;
+        v->estado = (int) cor;
+        if(cor + 1 > n_cores)
+            n_cores = cor + 1;
     }
 
-    for(elem_v = primeiro_no(g->v); elem_v; elem_v = proximo_no(elem_v)) {
+    classe = ALOCA(MEM_ALGORITMOS, n_cores * sizeof(lista) + 1);
+    for(cor = 0; cor < n_cores; ++cor)
+        classe[cor] = constroi_lista();
+    for(i = 0; i < (int) n; ++i)
+        insere_lista(vetor[i], classe[vetor[i]->estado]);
+    l = constroi_lista();
+    for(cor = n_cores; cor > 0; --cor)
+        insere_lista(classe[cor-1], l);
+
+    LIBERA(classe);
+    LIBERA(usada);
+    LIBERA(vetor);
+    return l;
+}
 
-        l = constroi_lista();
+lista conjunto_independente_maximo(lista ordem, grafo g) {
+    /* Algoritmo de Gavril: percorre a OPE escolhendo cada vertice cujos
+     * vizinhos ainda nao foram escolhidos. v->estado == VERM indica que v ou
+     * algum vizinho de v ja esta no conjunto. */
+    if(g == NULL)
+        return NULL;
+
+    no elem, elem2;
+    aresta a;
+    vertice v;
+    lista l = constroi_lista();
 
-        for(elem_aux = primeiro_no(g->v); elem_aux; elem_aux = proximo_no(elem_aux)) {
-            v = (vertice) conteudo(elem_aux);
-            v->visitado = 0;
+    for(elem = primeiro_no(ordem); elem; elem = proximo_no(elem)) {
+        v = (vertice) conteudo(elem);
+        v->estado = BRAN;
+    }
+    for(elem = primeiro_no(ordem); elem; elem = proximo_no(elem)) {
+        v = (vertice) conteudo(elem);
+        if(v->estado != BRAN)
+            continue;
+        insere_lista(v, l);
+        v->estado = VERM;
+        for(elem2 = primeiro_no(v->entrada); elem2; elem2 = proximo_no(elem2)) {
+            a = (aresta) conteudo(elem2);
+            a->vs->estado = VERM;
+        }
+        for(elem2 = primeiro_no(v->saida); elem2; elem2 = proximo_no(elem2)) {
+            a = (aresta) conteudo(elem2);
+            a->vc->estado = VERM;
         }
+    }
+    return l;
+}
 
-        v = (vertice) conteudo(elem_v);
-        v->visitado = 1;
+grafo triangulacao_minima(grafo g, lista *ordem) {
+    /* MCS-M: numera os vertices de n-1 ate 0, escolhendo sempre o vertice v
+     * nao numerado de maior peso. Depois de escolher v, incrementa o peso de
+     * todo vertice nao numerado u alcancavel a partir de v por um caminho de
+     * vertices nao numerados de peso menor que o de u. Se u nao eh vizinho
+     * de v, {u, v} eh uma aresta do preenchimento.
+     * A busca eh feita com baldes indexados pelo maior peso visto no caminho.
+     * Os vertices nao numerados ficam em listas duplamente encadeadas por
+     * peso (fila_peso); como cada passo aumenta os pesos de no maximo 1, o
+     * maior peso so desce O(|V|) vezes no total e a escolha custa O(1)
+     * amortizado. O indice de cada vertice fica em v->atributo. */
+    if(g == NULL || g->direcao)
+        return NULL;
+
+    unsigned int n = n_vertices(g), n_alcancados, n_vizinhos, k, j, maior, topo = 0;
+    int i, y;
+    vertice v, u, z;
+    vertice *vetor = numera_ordem(g->v);
+    vertice *copia = ALOCA_ZERADO(MEM_ALGORITMOS, n + 1, sizeof(vertice));
+    unsigned int *peso = ALOCA_ZERADO(MEM_ALGORITMOS, n + 1, sizeof(unsigned int));
+    int *numero = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(int));
+    int *alcancado = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(int));
+    int *balde = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(int));
+    int *prox = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(int));
+    int *s = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(int));
+    int *fila_peso = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(int));
+    int *prox_peso = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(int));
+    int *ant_peso = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(int));
+    cursor_vizinhanca c;
+    grafo f;
+
+    if(!vetor || !copia || !peso || !numero || !alcancado || !balde || !prox || !s
+       || !fila_peso || !prox_peso || !ant_peso) {
+        perror("(triangulacao_minima) Erro ao allocar memoria.");
+        LIBERA(vetor); LIBERA(copia); LIBERA(peso); LIBERA(numero);
+        LIBERA(alcancado); LIBERA(balde); LIBERA(prox); LIBERA(s);
+        LIBERA(fila_peso); LIBERA(prox_peso); LIBERA(ant_peso);
+        return NULL;
+    }
+    for(k = 0; k < n; ++k) {
+        numero[k] = alcancado[k] = balde[k] = fila_peso[k] = -1;
+    }
+    // Todos comecam com peso 0; o de menor indice fica na frente.
+    for(k = n; k-- > 0; ) {
+        ant_peso[k] = -1;
+        prox_peso[k] = fila_peso[0];
+        if(fila_peso[0] >= 0)
+            ant_peso[fila_peso[0]] = (int) k;
+        fila_peso[0] = (int) k;
+    }
 
-        if(!v->coberto) {
-            if(busca_caminho(v, l, 1)) {
-                if(primeiro_no(l)) { // Lista nao ta vazia.
-                    return l;
+    f = constroi_grafo();
+    snprintf(f->nome, TAM_NOME, "Preenchimento de %s", g->nome);
+    if(ordem)
+        *ordem = constroi_lista();
+
+    for(i = (int) n - 1; i >= 0; --i) {
+        // Escolhe o vertice nao numerado de maior peso e o tira da fila.
+        while(fila_peso[topo] < 0)
+            --topo;
+        y = fila_peso[topo];
+        fila_peso[topo] = prox_peso[y];
+        if(prox_peso[y] >= 0)
+            ant_peso[prox_peso[y]] = -1;
+        v = vetor[y];
+        numero[y] = i;
+        alcancado[y] = i;
+        if(ordem)
+            insere_lista(v, *ordem);
+
+        // Os vizinhos nao numerados de v sao alcancados diretamente.
+        n_alcancados = 0;
+        maior = 0;
+        for(inicia_vizinhanca(&c, v, VIZIN_COMPL); (u = proximo_vizinho(&c)); ) {
+            if(numero[u->atributo] >= 0 || alcancado[u->atributo] == i)
+                continue;
+            alcancado[u->atributo] = i;
+            prox[u->atributo] = balde[peso[u->atributo]];
+            balde[peso[u->atributo]] = u->atributo;
+            s[n_alcancados++] = u->atributo;
+            if(peso[u->atributo] > maior)
+                maior = peso[u->atributo];
+        }
+        n_vizinhos = n_alcancados;
+
+        // Esvazia os baldes em ordem crescente de peso.
+        for(j = 0; j <= maior; ++j) {
+            while(balde[j] >= 0) {
+                y = balde[j];
+                balde[j] = prox[y];
+                for(inicia_vizinhanca(&c, vetor[y], VIZIN_COMPL); (z = proximo_vizinho(&c)); ) {
+                    if(numero[z->atributo] >= 0 || alcancado[z->atributo] == i)
+                        continue;
+                    alcancado[z->atributo] = i;
+                    if(peso[z->atributo] > j) {
+                        prox[z->atributo] = balde[peso[z->atributo]];
+                        balde[peso[z->atributo]] = z->atributo;
+                        s[n_alcancados++] = z->atributo;
+                        if(peso[z->atributo] > maior)
+                            maior = peso[z->atributo];
+                    } else {
+                        prox[z->atributo] = balde[j];
+                        balde[j] = z->atributo;
+                    }
                 }
             }
         }
-        destroi_lista(l, NULL);
+
+        // Atualiza os pesos (mudando cada um de fila) e cria as arestas do
+        // preenchimento.
+        for(k = 0; k < n_alcancados; ++k) {
+            y = s[k];
+            if(ant_peso[y] >= 0)
+                prox_peso[ant_peso[y]] = prox_peso[y];
+            else
+                fila_peso[peso[y]] = prox_peso[y];
+            if(prox_peso[y] >= 0)
+                ant_peso[prox_peso[y]] = ant_peso[y];
+            ++peso[y];
+            ant_peso[y] = -1;
+            prox_peso[y] = fila_peso[peso[y]];
+            if(fila_peso[peso[y]] >= 0)
+                ant_peso[fila_peso[peso[y]]] = y;
+            fila_peso[peso[y]] = y;
+            if(peso[y] > topo)
+                topo = peso[y];
+            if(k < n_vizinhos)
+                continue;
+            if(!copia[s[k]])
+                copia[s[k]] = insere_vertice(f, vetor[s[k]]->nome);
+            if(!copia[v->atributo])
+                copia[v->atributo] = insere_vertice(f, v->nome);
+            insere_aresta(f, copia[v->atributo], copia[s[k]], PESO_DEFAULT);
+        }
     }
-    return NULL;
+
+    LIBERA(vetor); LIBERA(copia); LIBERA(peso); LIBERA(numero);
+    LIBERA(alcancado); LIBERA(balde); LIBERA(prox); LIBERA(s);
+    LIBERA(fila_peso); LIBERA(prox_peso); LIBERA(ant_peso);
+    return f;
 }
 
-grafo emparelhamento_maximo(grafo g) {
-    lista l;
-    grafo e;
-    no elem_v, elem_a;
-    vertice v;
+aresta procura_aresta(vertice u, vertice v) {
+    no elem;
     aresta a;
 
-    for(elem_v = primeiro_no(g->v); elem_v; elem_v = proximo_no(elem_v)) {
-        v = (vertice) conteudo(elem_v);
-        v->coberto = 0;
-        for(elem_a = primeiro_no(v->saida); elem_a; elem_a = proximo_no(elem_a)) {
-            a = (aresta) conteudo(elem_a);
-            a->coberta = 0;
-        }
+    for(elem = primeiro_no(u->saida); elem; elem = proximo_no(elem)) {
+        a = (aresta) conteudo(elem);
+        if(a->vc == v)
+            return a;
     }
-
-    while((l = caminho_aumentante(g)) != NULL) {
-        xor(l);
-        destroi_lista(l, NULL); // Nao destroi as arestas porque elas ainda fazem parte do grafo g.
+    for(elem = primeiro_no(u->entrada); elem; elem = proximo_no(elem)) {
+        a = (aresta) conteudo(elem);
+        if(a->vs == v)
+            return a;
     }
+    return NULL;
+}
 
-    e = constroi_grafo();
-    strcpy(e->nome, "Max Matching");
-    copia_vertices(e,g);
-    copia_arestas_cobertas(e,g);
-    return e;
+void remove_aresta(grafo g, aresta a) {
+    remove_no(a->vs->saida, a->no_saida, NULL);
+    remove_no(a->vc->entrada, a->no_entrada, NULL);
+    --g->n_arestas;
+    g->hash = 0;
+    destroi_aresta(a);
 }
 
-grafo le_grafo(FILE *input) {
-    Agraph_t *g = agread(input, NULL);
-    Agnode_t *node;
-    Agedge_t *a;
-    char* aux;
-    char* attr = malloc(sizeof(char) * TAM_NOME);
-    strcpy(attr,"peso");
-    long int peso = PESO_DEFAULT;
-    int v_alterado = 0;
+aresta procura_arco(vertice u, vertice v) {
+    no elem;
+    aresta a;
 
-    grafo g2 = constroi_grafo();
+    // Procura na menor das duas listas em que o arco pode estar.
+    if(tamanho_lista(u->saida) <= tamanho_lista(v->entrada)) {
+        for(elem = primeiro_no(u->saida); elem; elem = proximo_no(elem)) {
+            a = (aresta) conteudo(elem);
+            if(a->vc == v)
+                return a;
+        }
+    } else {
+        for(elem = primeiro_no(v->entrada); elem; elem = proximo_no(elem)) {
+            a = (aresta) conteudo(elem);
+            if(a->vs == u)
+                return a;
+        }
+    }
+    return NULL;
+}
 
-    g2->direcao = agisdirected(g);
+int insere_aresta_entre(grafo g, vertice u, vertice v, long int peso) {
+    if(u == v || (g->direcao ? procura_arco(u, v) : procura_aresta(u, v)))
+        return 0;
+    if(insere_aresta(g, u, v, peso) == NULL)
+        return 0;
+    if(peso != PESO_DEFAULT)
+        g->ponderado = 1;
+    return 1;
+}
+
+int remove_aresta_entre(grafo g, vertice u, vertice v) {
+    aresta a = procura_arco(u, v);
+
+    // Em grafos nao direcionados a aresta pode ter sido guardada como v--u.
+    if(a == NULL && !g->direcao)
+        a = procura_arco(v, u);
+    if(a == NULL)
+        return 0;
+    remove_aresta(g, a);
+    return 1;
+}
+
+int remove_vertice(grafo g, vertice v) {
+    while(primeiro_no(v->saida))
+        remove_aresta(g, (aresta) conteudo(primeiro_no(v->saida)));
+    while(primeiro_no(v->entrada))
+        remove_aresta(g, (aresta) conteudo(primeiro_no(v->entrada)));
+    g->hash = 0;
+    return remove_no(g->v, v->no_grafo, destroi_vertice);
+}
+
+unsigned int proxima_marca(grafo g, unsigned int n) {
+    no elem;
+
+    if(g->marca > UINT_MAX - n - 1) {
+        // Acabaram as marcas: reseta todos os vertices e comeca de novo.
+        for(elem = primeiro_no(g->v); elem; elem = proximo_no(elem))
+            ((vertice) conteudo(elem))->marca = 0;
+        g->marca = 0;
+        CONTA(reinicios, 1);
+    }
+    CONTA(marcas, n);
+    g->marca += n;
+    return g->marca - n + 1;
+}
+
+lista vizinhos_comuns(grafo g, vertice u, vertice v, unsigned int *m) {
+    unsigned int m0 = proxima_marca(g, 2);
+    lista s = constroi_lista();
+    cursor_vizinhanca c;
+    vertice w;
+
+    for(inicia_vizinhanca(&c, u, VIZIN_COMPL); (w = proximo_vizinho(&c)); )
+        w->marca = m0;
+    for(inicia_vizinhanca(&c, v, VIZIN_COMPL); (w = proximo_vizinho(&c)); ) {
+        if(w->marca == m0) {
+            w->marca = m0 + 1;
+            insere_lista(w, s);
+        }
+    }
+    *m = m0 + 1;
+    return s;
+}
+
+int alcanca_evitando(grafo g, vertice u, vertice v, unsigned int m_bloq) {
+    /* u->marca = m (lado de u) e v->marca = m+1 (lado de v). Cada busca
+     * avanca um vertice por vez; se uma delas encontra um vertice do outro
+     * lado, u e v estao ligados. */
+    unsigned int m = proxima_marca(g, 2), lado;
+    lista pilha[2];
+    cursor_vizinhanca c;
+    vertice x, w;
+    int k, ligados = 0;
+
+    pilha[0] = constroi_lista();
+    pilha[1] = constroi_lista();
+    u->marca = m;
+    v->marca = m + 1;
+    insere_lista(u, pilha[0]);
+    insere_lista(v, pilha[1]);
+
+    while(!ligados && primeiro_no(pilha[0]) && primeiro_no(pilha[1])) {
+        for(k = 0; k < 2 && !ligados; ++k) {
+            lado = m + (unsigned int) k;
+            x = (vertice) conteudo(primeiro_no(pilha[k]));
+            remove_no(pilha[k], primeiro_no(pilha[k]), NULL);
+            for(inicia_vizinhanca(&c, x, VIZIN_COMPL); (w = proximo_vizinho(&c)); ) {
+                if(w->marca == m_bloq || w->marca == lado)
+                    continue;
+                if(w->marca >= m) { // Marcado pela outra busca.
+                    ligados = 1;
+                    break;
+                }
+                w->marca = lado;
+                insere_lista(w, pilha[k]);
+            }
+        }
+    }
+
+    destroi_lista(pilha[0], NULL);
+    destroi_lista(pilha[1], NULL);
+    return ligados;
+}
+
+cordal_dinamico constroi_cordal_dinamico(grafo g) {
+    if(g == NULL || g->direcao)
+        return NULL;
+
+    cordal_dinamico c = ALOCA(MEM_ALGORITMOS, sizeof(struct cordal_dinamico));
+    if(c == NULL) {
+        perror("(constroi_cordal_dinamico) Erro ao allocar memoria.");
+        return NULL;
+    }
+    c->g = g;
+    c->cordal = cordal(g);
+    return c;
+}
+
+int destroi_cordal_dinamico(cordal_dinamico c) {
+    LIBERA(c);
+    return 1;
+}
+
+int cordal_atual(cordal_dinamico c) {
+    if(c->cordal < 0)
+        c->cordal = cordal(c->g);
+    return c->cordal;
+}
+
+int insere_aresta_cordal(cordal_dinamico c, vertice u, vertice v) {
+    unsigned int m;
+    int antes = c->cordal;
+    lista s;
+
+    if(u == v || procura_aresta(u, v))
+        return c->cordal;
+
+    // Sem saber se g eh cordal nao ha teste local: fica pra cordal_atual.
+    if(c->cordal == 1) {
+        // g+uv eh cordal sse N(u)∩N(v) separa u de v em g.
+        s = vizinhos_comuns(c->g, u, v, &m);
+        c->cordal = !alcanca_evitando(c->g, u, v, m);
+        destroi_lista(s, NULL);
+    } else {
+        c->cordal = -1;
+    }
+    if(insere_aresta(c->g, u, v, PESO_DEFAULT) == NULL) {
+        perror("(insere_aresta_cordal) Erro ao inserir aresta.");
+        c->cordal = antes; // g nao mudou.
+    }
+    return c->cordal;
+}
+
+int remove_aresta_cordal(cordal_dinamico c, vertice u, vertice v) {
+    unsigned int m, n_s, cont;
+    lista s;
+    no elem;
+    cursor_vizinhanca cur;
+    vertice w, x;
+    aresta a = procura_aresta(u, v);
+
+    if(a == NULL)
+        return c->cordal;
+
+    if(c->cordal == 1) {
+        // g-uv eh cordal sse N(u)∩N(v) eh uma clique: cada vertice de S tem
+        // que ter os outros |S|-1 como vizinhos.
+        s = vizinhos_comuns(c->g, u, v, &m);
+        n_s = tamanho_lista(s);
+        for(elem = primeiro_no(s); elem && c->cordal; elem = proximo_no(elem)) {
+            w = (vertice) conteudo(elem);
+            cont = 0;
+            for(inicia_vizinhanca(&cur, w, VIZIN_COMPL); (x = proximo_vizinho(&cur)); )
+                if(x->marca == m)
+                    ++cont;
+            if(cont + 1 < n_s)
+                c->cordal = 0;
+        }
+        destroi_lista(s, NULL);
+    } else {
+        c->cordal = -1;
+    }
+    remove_aresta(c->g, a);
+    return c->cordal;
+}
+
+inline int aresta_coberta(aresta a) {
+    return a->coberta;
+}
+
+void copia_vertices(grafo g1, grafo g2) {
+    /* Versão criando vértices novos (pois devo mudar a lista de vizinhança dele).
+       Copia os vértices de g2 para g1 (g1 é um grafo vazio no início) */
+    no elem;
+    vertice v;
+
+    for(elem = primeiro_no(g2->v); elem; elem = proximo_no(elem)) {
+        // Cria um novo vertice.
+        v = (vertice) conteudo(elem);
+        if(v->coberto)
+            insere_vertice(g1, v->nome );
+    }
+}
+
+void copia_arestas_cobertas(grafo g1, grafo g2) {
+    /* Copia arestas de g2 cobertas pelo emparalhamento para g1.
+     * A ideia é parecida com a leitura do grafo: eu leio um vértice v
+     * do grafo g2, que é o grafo que tem as arestas, e percorro a sua
+     * vizinhança. Como os vértices do grafo g1 são diferentes dos vértices
+     * de g2, eu tenho que procurar o semelhante a v em g1, que vou salvar
+     * em v_saida. Depois, percorre a vizinhança de v (porque ele tem as
+     * arestas) e acha o vértice de chegada. Com esse vertice de chegada
+     * (a->vc), pego o semelhante a ele em g1, que salvo em v_chegada.
+     * Depois, insiro em g1. */
+    no elem_v, elem_a;
+    vertice v, v_saida, v_chegada;
+    aresta a;
+
+    for(elem_v = primeiro_no(g2->v); elem_v; elem_v = proximo_no(elem_v)) {
+        v = (vertice) conteudo(elem_v);
+        v_saida = procura_vertice(g1, v->nome);
+        for(elem_a = primeiro_no(v->saida); elem_a; elem_a = proximo_no(elem_a)) {
+            a = (aresta) conteudo(elem_a);
+            if(aresta_coberta(a)) {
+                v_chegada = procura_vertice(g1, a->vc->nome);
+                insere_aresta(g1, v_saida, v_chegada, a->peso);
+            }
+        }
+    }
+}
+
+void xor(lista l) {
+/* Usando l como lista de arestas */
+    aresta a;
+    no elem;
+
+    for(elem = primeiro_no(l); elem; elem = proximo_no(elem)) {
+        a = (aresta) conteudo(elem);
+        a->vc->coberto = 1;
+        a->vs->coberto = 1;
+        a->coberta = !a->coberta;
+    }
+}
+
+int busca_caminho(vertice v, lista l, int last, unsigned int m, unsigned int limite) {
+    /* essa função é chamada pela função que tenta achar um caminho aumentante pra
+     * cada vértice não coberto (e retorna assim que achar) e last é inicialmente 1,
+     * pois a primeira aresta (que tenho que achar) será 0 (não coberta) */
+
+    if (!v->coberto && v->marca != m) {
+        return TRUE;
+    }
+    if (limite == 0) {
+        return FALSE;
+    }
+
+    no elem;
+    aresta a;
+    vertice w;
+
+    v->marca = m;
+
+    for(elem = primeiro_no(v->saida); elem; elem = proximo_no(elem)) {
+        a = (aresta) conteudo(elem);
+        CONTA(arestas_examinadas, 1);
+        if(a->coberta != last) {
+            w = a->vc; // w = vizinho do vértice
+            if(w->marca != m && busca_caminho(w, l, !last, m, limite - 1)) {
+                insere_lista(a, l);
+                return TRUE;
+            }
+        }
+    }
+    for(elem = primeiro_no(v->entrada); elem; elem = proximo_no(elem)) {
+        a = (aresta) conteudo(elem);
+        CONTA(arestas_examinadas, 1);
+        if(a->coberta != last) {
+            w = a->vs;
+            if(w->marca != m && busca_caminho(w, l, !last, m, limite - 1)) {
+                insere_lista(a, l);
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+unsigned int emparelha(grafo g) {
+    lista l;
+    no elem_v, elem_a;
+    vertice v;
+    aresta a;
+    unsigned int tamanho = 0, m;
+    INICIA_FASE(t);
+
+    for(elem_v = primeiro_no(g->v); elem_v; elem_v = proximo_no(elem_v)) {
+        v = (vertice) conteudo(elem_v);
+        v->coberto = 0;
+        for(elem_a = primeiro_no(v->saida); elem_a; elem_a = proximo_no(elem_a)) {
+            a = (aresta) conteudo(elem_a);
+            a->coberta = 0;
+        }
+    }
+
+    // Busca so a partir dos vertices livres do lado 0 (o menor), uma vez
+    // cada: se nao ha caminho aumentante a partir de v agora, nao passa a
+    // haver depois de outros aumentos. Os vertices visitados numa busca que
+    // falhou nao levam a vertice livre, entao a marca so muda quando aumenta.
+    m = proxima_marca(g, 1);
+    for(elem_v = primeiro_no(g->v); elem_v; elem_v = proximo_no(elem_v)) {
+        v = (vertice) conteudo(elem_v);
+        if(v->lado || v->coberto)
+            continue;
+        l = constroi_lista();
+        v->marca = m;
+        CONTA(buscas, 1);
+        if(busca_caminho(v, l, 1, m, SEM_LIMITE) && primeiro_no(l)) {
+            xor(l);
+            ++tamanho;
+            CONTA(aumentos, 1);
+            m = proxima_marca(g, 1);
+        }
+        destroi_lista(l, NULL); // Nao destroi as arestas porque elas ainda fazem parte do grafo g.
+    }
+    TERMINA_FASE(FASE_BUSCA, t);
+    return tamanho;
+}
+
+grafo grafo_emparelhamento(grafo g) {
+    INICIA_FASE(t);
+    grafo e = constroi_grafo();
+    strcpy(e->nome, "Max Matching");
+    copia_vertices(e,g);
+    copia_arestas_cobertas(e,g);
+    TERMINA_FASE(FASE_COPIA, t);
+    return e;
+}
+
+grafo emparelhamento_maximo(grafo g) {
+    if(!bipartido(g, NULL))
+        return NULL;
+    emparelha(g);
+    return grafo_emparelhamento(g);
+}
+
+int aumenta_a_partir_de(grafo g, vertice v, unsigned int limite) {
+    lista l = constroi_lista();
+    unsigned int m = proxima_marca(g, 1);
+    int aumentou = 0;
+
+    v->marca = m;
+    CONTA(buscas, 1);
+    if(!v->coberto && busca_caminho(v, l, 1, m, limite) && primeiro_no(l)) {
+        xor(l);
+        aumentou = 1;
+        CONTA(aumentos, 1);
+    }
+    destroi_lista(l, NULL);
+    return aumentou;
+}
+
+int aumenta_por_aresta(grafo g, aresta a) {
+    /* Um caminho aumentante que passa por a = {u,v} eh formado por um
+     * caminho alternante de u ate um vertice livre x que comeca pela aresta
+     * coberta de u, pela propria a e por um caminho analogo de v ate um
+     * vertice livre y. Cada metade eh achada por uma busca independente
+     * (busca_caminho com last = 0). As duas metades podem se cruzar, mas num
+     * grafo bipartido todo ciclo tem tamanho par, entao basta apagar os
+     * ciclos do passeio x..u-v..y para obter um caminho alternante. */
+    lista l1 = constroi_lista(), l2 = constroi_lista();
+    unsigned int m1 = proxima_marca(g, 2), n, k, i, j;
+    vertice *vs;
+    aresta *as;
+    vertice w;
+    no elem;
+    lista caminho;
+    int aumentou = 0;
+
+    if(!busca_caminho(a->vs, l1, 0, m1, SEM_LIMITE) || !busca_caminho(a->vc, l2, 0, m1 + 1, SEM_LIMITE)) {
+        destroi_lista(l1, NULL);
+        destroi_lista(l2, NULL);
+        return 0;
+    }
+
+    // Monta o passeio x .. u v .. y em vs[0..n] (vertices) e as[0..n-1]
+    // (arestas). l1 vai de u ate x, entao eh percorrida de tras pra frente.
+    n = tamanho_lista(l1) + 1 + tamanho_lista(l2);
+    vs = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(vertice));
+    as = ALOCA(MEM_ALGORITMOS, n * sizeof(aresta));
+    if(!vs || !as) {
+        perror("(aumenta_por_aresta) Erro ao allocar memoria.");
+        LIBERA(vs);
+        LIBERA(as);
+        destroi_lista(l1, NULL);
+        destroi_lista(l2, NULL);
+        return 0;
+    }
+    k = tamanho_lista(l1);
+    vs[k] = a->vs;
+    for(w = a->vs, i = k, elem = primeiro_no(l1); elem; elem = proximo_no(elem)) {
+        as[--i] = (aresta) conteudo(elem);
+        w = as[i]->vs == w ? as[i]->vc : as[i]->vs;
+        vs[i] = w;
+    }
+    as[k] = a;
+    vs[k + 1] = a->vc;
+    for(w = a->vc, i = k + 1, elem = primeiro_no(l2); elem; elem = proximo_no(elem), ++i) {
+        as[i] = (aresta) conteudo(elem);
+        w = as[i]->vs == w ? as[i]->vc : as[i]->vs;
+        vs[i + 1] = w;
+    }
+
+    // Apaga os ciclos: de cada vertice pula direto pra sua ultima ocorrencia.
+    for(i = 0; i <= n; ++i)
+        vs[i]->atributo = (int) i;
+    caminho = constroi_lista();
+    for(i = 0; i < n; i = j + 1) {
+        j = (unsigned int) vs[i]->atributo;
+        if(j >= n)
+            break;
+        insere_lista(as[j], caminho);
+    }
+    if(primeiro_no(caminho)) {
+        xor(caminho);
+        aumentou = 1;
+    }
+
+    destroi_lista(caminho, NULL);
+    destroi_lista(l1, NULL);
+    destroi_lista(l2, NULL);
+    LIBERA(vs);
+    LIBERA(as);
+    return aumentou;
+}
+
+emparelhamento_dinamico constroi_emparelhamento_dinamico(grafo g) {
+    emparelhamento_dinamico d = ALOCA(MEM_ALGORITMOS, sizeof(struct emparelhamento_dinamico));
+
+    if(d == NULL) {
+        perror("(constroi_emparelhamento_dinamico) Erro ao allocar memoria.");
+        return NULL;
+    }
+    if(!bipartido(g, NULL)) {
+        LIBERA(d);
+        return NULL;
+    }
+    d->g = g;
+    d->tamanho = emparelha(g);
+    d->limite = SEM_LIMITE;
+    d->periodo = 0;
+    d->chegadas = 0;
+    d->maximo = 1;
+    return d;
+}
+
+void limita_chegadas(emparelhamento_dinamico d, unsigned int limite, unsigned int periodo) {
+    d->limite = limite ? limite : SEM_LIMITE;
+    d->periodo = periodo;
+}
+
+vertice chegada_emparelhamento(emparelhamento_dinamico d, char *nome, lista vizinhos) {
+    vertice v = insere_vertice(d->g, nome), w;
+    no elem;
+    aresta a, livre = NULL;
+
+    if(v == NULL)
+        return NULL;
+    for(elem = primeiro_no(vizinhos); elem; elem = proximo_no(elem)) {
+        w = (vertice) conteudo(elem);
+        if((a = insere_aresta(d->g, w, v, PESO_DEFAULT)) == NULL) {
+            perror("(chegada_emparelhamento) Erro ao inserir aresta.");
+            return NULL;
+        }
+        a->coberta = 0;
+        if(!w->coberto && !livre)
+            livre = a;
+    }
+    v->coberto = 0;
+
+    // Todo caminho aumentante novo comeca em v. Se algum vizinho de v esta
+    // livre, o caminho de uma aresta basta e nao precisa de busca.
+    if(livre) {
+        livre->coberta = 1;
+        livre->vs->coberto = v->coberto = 1;
+        ++d->tamanho;
+    } else if(aumenta_a_partir_de(d->g, v, d->limite))
+        ++d->tamanho;
+    else if(d->limite != SEM_LIMITE && tamanho_lista(vizinhos))
+        d->maximo = 0;
+
+    if(d->periodo && ++d->chegadas >= d->periodo)
+        reotimiza_emparelhamento(d);
+    return par(d, v);
+}
+
+unsigned int reotimiza_emparelhamento(emparelhamento_dinamico d) {
+    /* Num grafo bipartido, se nao existe caminho aumentante a partir de um
+     * vertice livre v, continua nao existindo depois de aumentar o
+     * emparelhamento por outros caminhos. Entao basta uma passada pelos
+     * vertices livres. */
+    no elem;
+    vertice v;
+
+    d->chegadas = 0;
+    if(d->maximo)
+        return d->tamanho;
+    for(elem = primeiro_no(d->g->v); elem; elem = proximo_no(elem)) {
+        v = (vertice) conteudo(elem);
+        if(!v->coberto && aumenta_a_partir_de(d->g, v, SEM_LIMITE))
+            ++d->tamanho;
+    }
+    d->maximo = 1;
+    return d->tamanho;
+}
+
+int destroi_emparelhamento_dinamico(emparelhamento_dinamico d) {
+    LIBERA(d);
+    return 1;
+}
+
+unsigned int tamanho_emparelhamento(emparelhamento_dinamico d) {
+    return d->tamanho;
+}
+
+vertice par(emparelhamento_dinamico d, vertice v) {
+    no elem;
+    aresta a;
+
+    if(d == NULL || !v->coberto)
+        return NULL;
+    for(elem = primeiro_no(v->saida); elem; elem = proximo_no(elem)) {
+        a = (aresta) conteudo(elem);
+        if(a->coberta)
+            return a->vc;
+    }
+    for(elem = primeiro_no(v->entrada); elem; elem = proximo_no(elem)) {
+        a = (aresta) conteudo(elem);
+        if(a->coberta)
+            return a->vs;
+    }
+    return NULL;
+}
+
+grafo emparelhamento_atual(emparelhamento_dinamico d) {
+    return grafo_emparelhamento(d->g);
+}
+
+unsigned int insere_aresta_emparelhamento(emparelhamento_dinamico d, vertice u, vertice v, long int peso) {
+    aresta a = insere_aresta(d->g, u, v, peso);
+
+    if(a == NULL) {
+        perror("(insere_aresta_emparelhamento) Erro ao inserir aresta.");
+        return d->tamanho;
+    }
+    if(peso != PESO_DEFAULT)
+        d->g->ponderado = 1;
+    a->coberta = 0;
+    // O emparelhamento era maximo, entao so pode aumentar por um caminho
+    // que passe por a (se u e v estao livres, o caminho eh a propria a).
+    if(aumenta_por_aresta(d->g, a))
+        ++d->tamanho;
+    return d->tamanho;
+}
+
+unsigned int remove_aresta_emparelhamento(emparelhamento_dinamico d, vertice u, vertice v) {
+    aresta a = procura_arco(u, v);
+
+    if(a == NULL && !d->g->direcao)
+        a = procura_arco(v, u);
+    if(a == NULL)
+        return d->tamanho;
+    if(!a->coberta) {
+        // O emparelhamento continua valido e nao pode ficar maior.
+        remove_aresta(d->g, a);
+        return d->tamanho;
+    }
+    remove_aresta(d->g, a);
+    u->coberto = v->coberto = 0;
+    --d->tamanho;
+    // Todo caminho aumentante novo comeca em u ou em v, e o emparelhamento
+    // pode crescer de no maximo 1.
+    if(aumenta_a_partir_de(d->g, u, SEM_LIMITE) || aumenta_a_partir_de(d->g, v, SEM_LIMITE))
+        ++d->tamanho;
+    return d->tamanho;
+}
+
+vertice outra_ponta(aresta a, vertice v) {
+    return a->vs == v ? a->vc : a->vs;
+}
+
+int bipartido(grafo g, lista *ciclo_impar) {
+    unsigned int n = n_vertices(g), i, ini, fim = 0, comp, n0, x, y;
+    unsigned int *fila = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    unsigned int *pai = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    unsigned int *prof = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    vertice *vetor = numera_ordem(g->v), w;
+    cursor_vizinhanca c;
+    lista volta;
+    no elem;
+    int ok = 1;
+    INICIA_FASE(t);
+
+    if(ciclo_impar)
+        *ciclo_impar = NULL;
+    if(!fila || !pai || !prof || !vetor) {
+        perror("(bipartido) Erro ao allocar memoria.");
+        ok = 0;
+        goto fim;
+    }
+    for(i = 0; i < n; ++i)
+        prof[i] = NENHUM;
+    for(i = 0; i < n && ok; ++i) {
+        if(prof[i] != NENHUM)
+            continue;
+        // Busca em largura na componente de i, que ocupa fila[comp, fim).
+        prof[i] = 0;
+        pai[i] = NENHUM;
+        vetor[i]->lado = 0;
+        comp = fim;
+        fila[fim++] = i;
+        for(n0 = 0, ini = comp; ini < fim && ok; ++ini) {
+            x = fila[ini];
+            if(vetor[x]->lado == 0)
+                ++n0;
+            for(inicia_vizinhanca(&c, vetor[x], VIZIN_COMPL); (w = proximo_vizinho(&c)); ) {
+                y = (unsigned int) w->atributo;
+                if(prof[y] == NENHUM) {
+                    prof[y] = prof[x] + 1;
+                    pai[y] = x;
+                    w->lado = !vetor[x]->lado;
+                    fila[fim++] = y;
+                } else if(w->lado == vetor[x]->lado) {
+                    ok = 0;
+                    break;
+                }
+            }
+        }
+        if(!ok) {
+            if(ciclo_impar == NULL)
+                break;
+            // x e y tem a mesma cor: o ciclo impar eh x ... lca ... y.
+            // Monta a lista de tras pra frente (insere_lista insere no inicio).
+            *ciclo_impar = constroi_lista();
+            volta = constroi_lista();
+            for(; prof[x] > prof[y]; x = pai[x])
+                insere_lista(vetor[x], *ciclo_impar);
+            for(; prof[y] > prof[x]; y = pai[y])
+                insere_lista(vetor[y], volta);
+            for(; x != y; x = pai[x], y = pai[y]) {
+                insere_lista(vetor[x], *ciclo_impar);
+                insere_lista(vetor[y], volta);
+            }
+            insere_lista(vetor[x], *ciclo_impar);
+            for(elem = primeiro_no(volta); elem; elem = proximo_no(elem))
+                insere_lista(conteudo(elem), *ciclo_impar);
+            destroi_lista(volta, NULL);
+            break;
+        }
+        // Deixa o menor lado da componente como lado 0.
+        if(2 * n0 > fim - comp)
+            for(ini = comp; ini < fim; ++ini)
+                vetor[fila[ini]]->lado = !vetor[fila[ini]]->lado;
+    }
+
+fim:
+    LIBERA(fila); LIBERA(pai); LIBERA(prof); LIBERA(vetor);
+    TERMINA_FASE(FASE_BIPARTIDO, t);
+    return ok;
+}
+
+int lado_vertice(vertice v) {
+    return v->lado;
+}
+
+int insere_heap(struct heap *h, long int d, unsigned int x) {
+    unsigned int i, pai;
+    struct item_heap *novo;
+
+    if(h->n == h->capacidade) {
+        h->capacidade = 2 * h->capacidade + 16;
+        novo = REALOCA(MEM_ALGORITMOS, h->item, h->capacidade * sizeof(struct item_heap));
+        if(novo == NULL) {
+            perror("(insere_heap) Erro ao allocar memoria.");
+            return 0;
+        }
+        h->item = novo;
+    }
+    for(i = h->n++; i > 0 && h->item[pai = (i - 1) / 2].d > d; i = pai)
+        h->item[i] = h->item[pai];
+    h->item[i].d = d;
+    h->item[i].x = x;
+    return 1;
+}
+
+struct item_heap remove_heap(struct heap *h) {
+    struct item_heap topo = h->item[0], ultimo = h->item[--h->n];
+    unsigned int i = 0, filho;
+
+    while((filho = 2 * i + 1) < h->n) {
+        if(filho + 1 < h->n && h->item[filho + 1].d < h->item[filho].d)
+            ++filho;
+        if(h->item[filho].d >= ultimo.d)
+            break;
+        h->item[i] = h->item[filho];
+        i = filho;
+    }
+    h->item[i] = ultimo;
+    return topo;
+}
+
+grafo emparelhamento_ponderado(grafo g, int maximizar, int perfeito, long int *peso_total) {
+    /* Caminhos aumentantes mais curtos (Jonker-Volgenant / hungaro esparso).
+     * O custo de uma aresta eh -peso (maximizar) ou peso (minimizar). Cada
+     * fase faz um Dijkstra com custos reduzidos c(l,r) + pot[l] - pot[r] >= 0
+     * a partir de todos os vertices livres do lado 0 (o menor, ver
+     * bipartido) ate o vertice livre mais proximo do lado 1, e aumenta o
+     * emparelhamento pelo caminho encontrado. As arestas do emparelhamento
+     * tem custo reduzido 0 e sao percorridas da direita pra esquerda.
+     * O custo dos caminhos cresce a cada fase, entao sem "perfeito" basta
+     * parar quando o caminho mais curto deixa de diminuir o custo total. */
+    if(g == NULL)
+        return NULL;
+
+    unsigned int n = n_vertices(g), i, n_feitos, x, r, alvo;
+    unsigned int *feitos;
+    int *fase, f;
+    long int *dist, *pot, custo, d, pot_livre = 0;
+    aresta *par_a, *pred, a, antiga;
+    vertice *vetor, w;
+    cursor_vizinhanca c;
+    struct heap h = { NULL, 0, 0 };
+    struct item_heap it;
+    grafo e;
+
+    if(!bipartido(g, NULL))
+        return NULL;
+    vetor = numera_ordem(g->v);
+    fase = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(int));
+    feitos = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    dist = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(long int));
+    pot = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(long int));
+    par_a = ALOCA_ZERADO(MEM_ALGORITMOS, n + 1, sizeof(aresta));
+    pred = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(aresta));
+    if(!vetor || !fase || !feitos || !dist || !pot || !par_a || !pred) {
+        perror("(emparelhamento_ponderado) Erro ao allocar memoria.");
+        e = NULL;
+        goto fim;
+    }
+
+    // Potenciais iniciais: 0 na esquerda e o menor custo de aresta na
+    // direita. Todos os vertices livres de um mesmo lado tem sempre o mesmo
+    // potencial, entao o primeiro vertice livre da direita que sai do heap
+    // eh a ponta do caminho aumentante de menor custo real.
+    for(d = 0, f = 0, i = 0; i < n; ++i) {
+        fase[i] = -1;
+        for(inicia_vizinhanca(&c, vetor[i], VIZIN_SAIDA); (a = proxima_incidente(&c)); f = 1) {
+            custo = maximizar ? -a->peso : a->peso;
+            if(!f || custo < d)
+                d = custo;
+        }
+    }
+    for(i = 0; i < n; ++i)
+        pot[i] = vetor[i]->lado == 0 ? 0 : d;
+
+    for(f = 0; ; ++f) {
+        // Dijkstra a partir de todos os vertices livres da esquerda, que
+        // tem todos o mesmo potencial pot_livre.
+        h.n = 0;
+        n_feitos = 0;
+        alvo = n;
+        CONTA(buscas, 1);
+        for(i = 0; i < n; ++i) {
+            if(vetor[i]->lado == 0 && !par_a[i]) {
+                dist[i] = 0;
+                fase[i] = 2 * f;
+                pred[i] = NULL;
+                if(!insere_heap(&h, 0, i))
+                    break;
+            }
+        }
+        while(h.n) {
+            it = remove_heap(&h);
+            x = it.x;
+            if(fase[x] != 2 * f || it.d != dist[x])
+                continue; // Ja finalizado (fase 2f+1) ou entrada velha.
+            fase[x] = 2 * f + 1;
+            feitos[n_feitos++] = x;
+            if(vetor[x]->lado) {
+                if(!par_a[x]) {
+                    alvo = x;
+                    break;
+                }
+                // Segue a aresta do emparelhamento, de custo reduzido 0.
+                w = outra_ponta(par_a[x], vetor[x]);
+                dist[w->atributo] = it.d;
+                fase[w->atributo] = 2 * f;
+                pred[w->atributo] = par_a[x];
+                insere_heap(&h, it.d, (unsigned int) w->atributo);
+                continue;
+            }
+            for(inicia_vizinhanca(&c, vetor[x], VIZIN_COMPL); (a = proxima_incidente(&c)); ) {
+                CONTA(arestas_examinadas, 1);
+                if(a == par_a[x])
+                    continue;
+                r = (unsigned int) outra_ponta(a, vetor[x])->atributo;
+                if(fase[r] == 2 * f + 1)
+                    continue;
+                custo = maximizar ? -a->peso : a->peso;
+                d = it.d + custo + pot[x] - pot[r];
+                if(fase[r] != 2 * f || d < dist[r]) {
+                    fase[r] = 2 * f;
+                    dist[r] = d;
+                    pred[r] = a;
+                    insere_heap(&h, d, r);
+                }
+            }
+        }
+        if(alvo == n)
+            break; // Nao ha mais caminho aumentante.
+        d = dist[alvo];
+        // Custo real do caminho: soma dos custos reduzidos corrigida pelos
+        // potenciais das pontas.
+        if(!perfeito && d - pot_livre + pot[alvo] > 0)
+            break;
+
+        // Atualiza os potenciais (deslocados de -d para que so os vertices
+        // finalizados mudem) e aumenta o emparelhamento.
+        for(i = 0; i < n_feitos; ++i)
+            pot[feitos[i]] -= d - dist[feitos[i]];
+        pot_livre -= d;
+        CONTA(aumentos, 1);
+        for(x = alvo; ; x = (unsigned int) outra_ponta(antiga, w)->atributo) {
+            a = pred[x];
+            w = outra_ponta(a, vetor[x]);
+            antiga = par_a[w->atributo];
+            par_a[x] = par_a[w->atributo] = a;
+            if(antiga == NULL)
+                break;
+        }
+    }
+
+    // Marca o emparelhamento no grafo e monta o resultado.
+    custo = 0;
+    for(i = 0; i < n; ++i) {
+        vetor[i]->coberto = par_a[i] != NULL;
+        for(inicia_vizinhanca(&c, vetor[i], VIZIN_SAIDA); (a = proxima_incidente(&c)); ) {
+            a->coberta = a == par_a[i];
+            if(a->coberta)
+                custo += a->peso;
+        }
+    }
+    if(peso_total)
+        *peso_total = custo;
+    e = grafo_emparelhamento(g);
+    e->ponderado = g->ponderado;
+
+fim:
+    LIBERA(vetor); LIBERA(fase); LIBERA(feitos);
+    LIBERA(dist); LIBERA(pot); LIBERA(par_a); LIBERA(pred); LIBERA(h.item);
+    return e;
+}
+
+unsigned int melhor_lance(struct leilao *l, unsigned int i, long int *lance) {
+    unsigned int k, k1 = l->ini[i];
+    long int v, v1 = LONG_MIN, v2 = LONG_MIN;
+
+    for(k = l->ini[i]; k < l->ini[i+1]; ++k) {
+        v = l->benef[k] - l->preco[l->obj[k]];
+        if(v > v1) {
+            v2 = v1;
+            v1 = v;
+            k1 = k;
+        } else if(v > v2) {
+            v2 = v;
+        }
+    }
+    if(v2 == LONG_MIN)
+        v2 = v1; // Um objeto so: ninguem mais disputa com ele.
+    *lance = l->preco[l->obj[k1]] + v1 - v2 + l->eps;
+    return k1;
+}
+
+void calcula_lances(struct leilao *l, unsigned int t) {
+    unsigned int ini = (unsigned int) ((unsigned long) l->n_livres * t / l->n_threads);
+    unsigned int fim = (unsigned int) ((unsigned long) l->n_livres * (t + 1) / l->n_threads);
+
+    for(; ini < fim; ++ini)
+        l->lance_arco[ini] = melhor_lance(l, l->livres[ini], &l->lance[ini]);
+}
+
+void *thread_leilao(void *arg) {
+    struct leilao *l = arg;
+    unsigned int t, passo = 0;
+
+    pthread_mutex_lock(&l->trava);
+    t = ++l->pendentes; // Cada thread pega um numero de fatia diferente.
+    pthread_cond_signal(&l->fim);
+    for(;;) {
+        while(l->passo == passo && !l->encerra)
+            pthread_cond_wait(&l->inicio, &l->trava);
+        if(l->encerra)
+            break;
+        passo = l->passo;
+        pthread_mutex_unlock(&l->trava);
+        calcula_lances(l, t);
+        pthread_mutex_lock(&l->trava);
+        if(--l->pendentes == 0)
+            pthread_cond_signal(&l->fim);
+    }
+    pthread_mutex_unlock(&l->trava);
+    return NULL;
+}
+
+void rodada_jacobi(struct leilao *l) {
+    unsigned int p, i, j, k, antigo, n_prox = 0, *troca;
+
+    // Lances em paralelo: a thread principal faz a fatia 0.
+    pthread_mutex_lock(&l->trava);
+    l->pendentes = l->n_threads - 1;
+    ++l->passo;
+    pthread_cond_broadcast(&l->inicio);
+    pthread_mutex_unlock(&l->trava);
+    calcula_lances(l, 0);
+    pthread_mutex_lock(&l->trava);
+    while(l->pendentes)
+        pthread_cond_wait(&l->fim, &l->trava);
+    pthread_mutex_unlock(&l->trava);
+
+    // Escolhe o maior lance de cada objeto.
+    if(++l->rodada == 0) {
+        memset(l->rodada_obj, 0, l->n * sizeof(unsigned int));
+        l->rodada = 1;
+    }
+    for(p = 0; p < l->n_livres; ++p) {
+        CONTA(buscas, 1);
+        CONTA(arestas_examinadas, l->ini[l->livres[p] + 1] - l->ini[l->livres[p]]);
+        j = l->obj[l->lance_arco[p]];
+        if(l->rodada_obj[j] != l->rodada || l->lance[p] > l->lance[l->vencedor[j]]) {
+            l->rodada_obj[j] = l->rodada;
+            l->vencedor[j] = p;
+        }
+    }
+
+    // Atribui os objetos aos vencedores; perdedores e desalojados ficam livres.
+    for(p = 0; p < l->n_livres; ++p) {
+        i = l->livres[p];
+        k = l->lance_arco[p];
+        j = l->obj[k];
+        if(l->vencedor[j] != p) {
+            l->prox_livres[n_prox++] = i;
+            continue;
+        }
+        antigo = l->dono[j];
+        if(antigo != NENHUM) {
+            l->arco_de[antigo] = NENHUM;
+            l->prox_livres[n_prox++] = antigo;
+        } else {
+            CONTA(aumentos, 1);
+        }
+        l->dono[j] = i;
+        l->arco_de[i] = k;
+        l->preco[j] = l->lance[p];
+    }
+    troca = l->livres;
+    l->livres = l->prox_livres;
+    l->prox_livres = troca;
+    l->n_livres = n_prox;
+}
+
+void rodadas_gauss_seidel(struct leilao *l) {
+    unsigned int i, j, k, antigo;
+    long int lance;
+
+    while(l->n_livres) {
+        i = l->livres[--l->n_livres];
+        k = melhor_lance(l, i, &lance);
+        CONTA(buscas, 1);
+        CONTA(arestas_examinadas, l->ini[i+1] - l->ini[i]);
+        j = l->obj[k];
+        antigo = l->dono[j];
+        if(antigo != NENHUM) {
+            l->arco_de[antigo] = NENHUM;
+            l->livres[l->n_livres++] = antigo;
+        } else {
+            CONTA(aumentos, 1);
+        }
+        l->dono[j] = i;
+        l->arco_de[i] = k;
+        l->preco[j] = lance;
+    }
+}
+
+long int folga_leilao(struct leilao *l) {
+    unsigned int i, k;
+    long int dual = 0, primal = 0, v, melhor;
+
+    // Dual = soma dos precos + soma do melhor lucro de cada licitante.
+    for(i = 0; i < l->n; ++i) {
+        dual += l->preco[i];
+        for(melhor = LONG_MIN, k = l->ini[i]; k < l->ini[i+1]; ++k) {
+            v = l->benef[k] - l->preco[l->obj[k]];
+            if(v > melhor)
+                melhor = v;
+        }
+        dual += melhor;
+        primal += l->benef[l->arco_de[i]];
+    }
+    return dual - primal;
+}
+
+grafo emparelhamento_leilao(grafo g, int maximizar, unsigned int n_threads, long int folga_maxima, long int *peso_total, long int *folga) {
+    /* Leilao com epsilon-escalonamento sobre a atribuicao quadrada descrita
+     * em struct leilao. Os beneficios sao multiplicados por n+1: com eps = 1
+     * (na escala nova) a atribuicao fica a menos de n < n+1 do otimo, ou
+     * seja, eh otima, pois os pesos sao inteiros. Cada fase divide eps por
+     * FATOR_EPS, ate que a folga provada (dual - primal) caiba em
+     * folga_maxima ou eps chegue a 1 (fase final exata). */
+    if(g == NULL)
+        return NULL;
+
+    unsigned int n = n_vertices(g), i, k, t, criadas = 0;
+    long int escala = (long int) n + 1, c_max = 0, gap = 0, peso;
+    struct leilao l;
+    pthread_t *threads = NULL;
+    vertice *vetor, w;
+    cursor_vizinhanca c;
+    aresta a;
+    grafo e = NULL;
+
+    memset(&l, 0, sizeof(struct leilao));
+    l.n = n;
+    l.n_threads = n_threads ? n_threads : 1;
+    if(!bipartido(g, NULL))
+        return NULL;
+    vetor = numera_ordem(g->v);
+    l.ini = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    if(!vetor || !l.ini) {
+        perror("(emparelhamento_leilao) Erro ao allocar memoria.");
+        goto fim;
+    }
+
+    // Monta a adjacencia compactada: objeto i mais os vizinhos de i.
+    for(l.ini[0] = 0, i = 0; i < n; ++i)
+        l.ini[i+1] = l.ini[i] + 1 + grau(vetor[i], VIZIN_COMPL, g);
+    k = l.ini[n];
+    l.obj = ALOCA(MEM_ALGORITMOS, (k + 1) * sizeof(unsigned int));
+    l.benef = ALOCA(MEM_ALGORITMOS, (k + 1) * sizeof(long int));
+    l.arco = ALOCA(MEM_ALGORITMOS, (k + 1) * sizeof(aresta));
+    l.preco = ALOCA_ZERADO(MEM_ALGORITMOS, n + 1, sizeof(long int));
+    l.lance = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(long int));
+    l.dono = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    l.arco_de = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    l.livres = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    l.prox_livres = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    l.lance_arco = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    l.vencedor = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    l.rodada_obj = ALOCA_ZERADO(MEM_ALGORITMOS, n + 1, sizeof(unsigned int));
+    if(!l.obj || !l.benef || !l.arco || !l.preco || !l.lance || !l.dono || !l.arco_de
+       || !l.livres || !l.prox_livres || !l.lance_arco || !l.vencedor || !l.rodada_obj) {
+        perror("(emparelhamento_leilao) Erro ao allocar memoria.");
+        goto fim;
+    }
+    for(i = 0; i < n; ++i) {
+        k = l.ini[i];
+        l.obj[k] = i;
+        l.benef[k] = 0;
+        l.arco[k++] = NULL;
+        for(inicia_vizinhanca(&c, vetor[i], VIZIN_COMPL); (a = proxima_incidente(&c)); ++k) {
+            w = outra_ponta(a, vetor[i]);
+            l.obj[k] = (unsigned int) w->atributo;
+            l.arco[k] = vetor[i]->lado == 0 ? a : NULL;
+            l.benef[k] = l.arco[k] ? (maximizar ? a->peso : -a->peso) * escala : 0;
+            if(l.benef[k] > c_max)
+                c_max = l.benef[k];
+            else if(-l.benef[k] > c_max)
+                c_max = -l.benef[k];
+        }
+    }
+
+    if(l.n_threads > 1) {
+        threads = ALOCA(MEM_ALGORITMOS, l.n_threads * sizeof(pthread_t));
+        if(threads == NULL) {
+            perror("(emparelhamento_leilao) Erro ao allocar memoria.");
+            goto fim;
+        }
+        pthread_mutex_init(&l.trava, NULL);
+        pthread_cond_init(&l.inicio, NULL);
+        pthread_cond_init(&l.fim, NULL);
+        // As threads pegam as fatias 1 a n_threads-1 (ver thread_leilao).
+        for(t = 1; t < l.n_threads; ++t) {
+            if(pthread_create(&threads[t], NULL, thread_leilao, &l)) {
+                perror("(emparelhamento_leilao) Erro ao criar thread.");
+                break;
+            }
+            ++criadas;
+        }
+        pthread_mutex_lock(&l.trava);
+        while(l.pendentes != criadas)
+            pthread_cond_wait(&l.fim, &l.trava);
+        l.pendentes = 0;
+        pthread_mutex_unlock(&l.trava);
+        l.n_threads = criadas + 1;
+    }
+
+    for(l.eps = c_max / FATOR_EPS > 1 ? c_max / FATOR_EPS : 1; ; l.eps = l.eps / FATOR_EPS > 1 ? l.eps / FATOR_EPS : 1) {
+        // Cada fase recomeca com todos livres, mas mantem os precos.
+        for(i = 0; i < n; ++i) {
+            l.dono[i] = l.arco_de[i] = NENHUM;
+            l.livres[i] = n - 1 - i;
+        }
+        l.n_livres = n;
+        while(l.n_threads > 1 && l.n_livres >= LIMIAR_JACOBI * l.n_threads)
+            rodada_jacobi(&l);
+        rodadas_gauss_seidel(&l);
+
+        gap = folga_leilao(&l) / escala;
+        if(l.eps == 1 || gap <= folga_maxima)
+            break;
+    }
+
+    // Marca o emparelhamento no grafo e monta o resultado.
+    for(i = 0; i < n; ++i) {
+        vetor[i]->coberto = 0;
+        for(inicia_vizinhanca(&c, vetor[i], VIZIN_SAIDA); (a = proxima_incidente(&c)); )
+            a->coberta = 0;
+    }
+    for(peso = 0, i = 0; i < n; ++i) {
+        if((a = l.arco[l.arco_de[i]])) {
+            a->coberta = a->vs->coberto = a->vc->coberto = 1;
+            peso += a->peso;
+        }
+    }
+    if(peso_total)
+        *peso_total = peso;
+    if(folga)
+        *folga = gap;
+    e = grafo_emparelhamento(g);
+    e->ponderado = g->ponderado;
+
+fim:
+    if(threads) {
+        pthread_mutex_lock(&l.trava);
+        l.encerra = 1;
+        pthread_cond_broadcast(&l.inicio);
+        pthread_mutex_unlock(&l.trava);
+        for(t = 1; t <= criadas; ++t)
+            pthread_join(threads[t], NULL);
+        pthread_mutex_destroy(&l.trava);
+        pthread_cond_destroy(&l.inicio);
+        pthread_cond_destroy(&l.fim);
+        LIBERA(threads);
+    }
+    LIBERA(vetor); LIBERA(l.ini); LIBERA(l.obj); LIBERA(l.benef); LIBERA(l.arco);
+    LIBERA(l.preco); LIBERA(l.lance); LIBERA(l.dono); LIBERA(l.arco_de); LIBERA(l.livres);
+    LIBERA(l.prox_livres); LIBERA(l.lance_arco); LIBERA(l.vencedor); LIBERA(l.rodada_obj);
+    return e;
+}
+
+unsigned int base_floracao(struct floracao *b, unsigned int x) {
+    unsigned int r = x, y;
+
+    while(b->base[r] != r)
+        r = b->base[r];
+    for(; x != r; x = y) {
+        y = b->base[x];
+        b->base[x] = r;
+    }
+    return r;
+}
+
+unsigned int ancestral_floracao(struct floracao *b, unsigned int x, unsigned int y) {
+    unsigned int t;
+
+    // Sobe alternadamente de x e de y; a primeira base visitada duas vezes
+    // eh o ancestral comum.
+    if(++b->carimbo == 0) {
+        memset(b->visita, 0, b->n * sizeof(unsigned int));
+        b->carimbo = 1;
+    }
+    for(;; t = x, x = y, y = t) {
+        if(x == NENHUM)
+            continue;
+        x = base_floracao(b, x);
+        if(b->visita[x] == b->carimbo)
+            return x;
+        b->visita[x] = b->carimbo;
+        x = b->par[x] == NENHUM ? NENHUM : b->elo[b->par[x]];
+    }
+}
+
+void contrai_floracao(struct floracao *b, unsigned int x, unsigned int y, unsigned int l) {
+    while(base_floracao(b, x) != l) {
+        b->elo[x] = y;
+        y = b->par[x];
+        if(b->rotulo[y] == IMPAR) {
+            b->rotulo[y] = PAR;
+            b->fila[b->fim++] = y;
+        }
+        if(base_floracao(b, x) == x)
+            b->base[x] = l;
+        if(base_floracao(b, y) == y)
+            b->base[y] = l;
+        x = b->elo[y];
+    }
+}
+
+int busca_floracao(struct floracao *b, unsigned int r) {
+    unsigned int x, y, l, prox, i;
+    cursor_vizinhanca c;
+    vertice w;
+    int achou = 0;
+
+    b->ini = b->fim = 0;
+    b->n_tocados = 0;
+    b->rotulo[r] = PAR;
+    b->tocados[b->n_tocados++] = r;
+    b->fila[b->fim++] = r;
+    while(b->ini < b->fim && !achou) {
+        x = b->fila[b->ini++];
+        for(inicia_vizinhanca(&c, b->vetor[x], VIZIN_COMPL); (w = proximo_vizinho(&c)); ) {
+            y = (unsigned int) w->atributo;
+            if(b->rotulo[y] == NENHUM) {
+                b->rotulo[y] = IMPAR;
+                b->elo[y] = x;
+                b->tocados[b->n_tocados++] = y;
+                if(b->par[y] == NENHUM) {
+                    // Caminho aumentante: inverte ate a raiz.
+                    for(; y != NENHUM; y = prox) {
+                        x = b->elo[y];
+                        prox = b->par[x];
+                        b->par[y] = x;
+                        b->par[x] = y;
+                    }
+                    achou = 1;
+                    break;
+                }
+                b->rotulo[b->par[y]] = PAR;
+                b->tocados[b->n_tocados++] = b->par[y];
+                b->fila[b->fim++] = b->par[y];
+            } else if(b->rotulo[y] == PAR && base_floracao(b, x) != base_floracao(b, y)) {
+                l = ancestral_floracao(b, x, y);
+                contrai_floracao(b, x, y, l);
+                contrai_floracao(b, y, x, l);
+            }
+        }
+    }
+    // Limpa so o que a busca tocou (vertices fora da arvore estao intactos).
+    for(i = 0; i < b->n_tocados; ++i) {
+        b->rotulo[b->tocados[i]] = NENHUM;
+        b->base[b->tocados[i]] = b->tocados[i];
+    }
+    return achou;
+}
+
+grafo emparelhamento_geral(grafo g) {
+    /* Algoritmo de Edmonds com as floracoes contraidas implicitamente por
+     * union-find (base[]), sem construir o grafo contraido: cada busca custa
+     * O(|E|·α) e so toca os vertices da arvore alternante. Comeca com um
+     * emparelhamento guloso, e cada vertice livre eh raiz de no maximo uma
+     * busca: se nao ha caminho aumentante a partir dele, nao passa a haver
+     * depois de outros aumentos. Tempo total O(|V|·|E|·α). */
+    if(g == NULL)
+        return NULL;
+
+    unsigned int n = n_vertices(g), i;
+    struct floracao b;
+    cursor_vizinhanca c;
+    vertice w;
+    aresta a;
+    grafo e = NULL;
+
+    memset(&b, 0, sizeof(struct floracao));
+    b.n = n;
+    b.vetor = numera_ordem(g->v);
+    b.par = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    b.elo = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    b.base = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    b.rotulo = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    b.visita = ALOCA_ZERADO(MEM_ALGORITMOS, n + 1, sizeof(unsigned int));
+    b.fila = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    b.tocados = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    if(!b.vetor || !b.par || !b.elo || !b.base || !b.rotulo || !b.visita || !b.fila || !b.tocados) {
+        perror("(emparelhamento_geral) Erro ao allocar memoria.");
+        goto fim;
+    }
+    for(i = 0; i < n; ++i) {
+        b.par[i] = NENHUM;
+        b.base[i] = i;
+        b.rotulo[i] = NENHUM;
+    }
+    // Emparelhamento guloso inicial.
+    for(i = 0; i < n; ++i) {
+        if(b.par[i] != NENHUM)
+            continue;
+        for(inicia_vizinhanca(&c, b.vetor[i], VIZIN_COMPL); (w = proximo_vizinho(&c)); ) {
+            if(b.par[w->atributo] == NENHUM && (unsigned int) w->atributo != i) {
+                b.par[i] = (unsigned int) w->atributo;
+                b.par[w->atributo] = i;
+                break;
+            }
+        }
+    }
+    for(i = 0; i < n; ++i) {
+        if(b.par[i] == NENHUM) {
+            CONTA(buscas, 1);
+            if(busca_floracao(&b, i))
+                CONTA(aumentos, 1);
+        }
+    }
+
+    // Marca o emparelhamento no grafo e monta o resultado.
+    for(i = 0; i < n; ++i)
+        b.vetor[i]->coberto = b.par[i] != NENHUM;
+    for(i = 0; i < n; ++i)
+        for(inicia_vizinhanca(&c, b.vetor[i], VIZIN_SAIDA); (a = proxima_incidente(&c)); )
+            a->coberta = 0;
+    for(i = 0; i < n; ++i) {
+        if(b.par[i] == NENHUM || b.par[i] < i)
+            continue;
+        for(inicia_vizinhanca(&c, b.vetor[i], VIZIN_COMPL); (a = proxima_incidente(&c)); ) {
+            if((unsigned int) outra_ponta(a, b.vetor[i])->atributo == b.par[i]) {
+                a->coberta = 1;
+                break;
+            }
+        }
+    }
+    e = grafo_emparelhamento(g);
+
+fim:
+    LIBERA(b.vetor); LIBERA(b.par); LIBERA(b.elo); LIBERA(b.base);
+    LIBERA(b.rotulo); LIBERA(b.visita); LIBERA(b.fila); LIBERA(b.tocados);
+    return e;
+}
+
+int aumenta_componente(struct componentes *c, unsigned int u, unsigned int marca, unsigned int *pilha, int atomico) {
+    unsigned int topo = 0, l, r, antiga;
+
+    CONTA(buscas, 1);
+    pilha[0] = u;
+    c->iter[u] = c->ini[u];
+    for(;;) {
+        l = pilha[topo];
+        if(c->iter[l] == c->ini[l+1]) {
+            if(topo-- == 0)
+                return 0;
+            continue;
+        }
+        r = c->adj[c->iter[l]++];
+        CONTA(arestas_examinadas, 1);
+        antiga = c->visita[r];
+        if(antiga == marca)
+            continue;
+        if(c->nivel && (c->par[r] == NENHUM ? c->nivel[l] != c->limite
+                        : c->nivel[l] == c->limite || c->nivel[c->par[r]] != c->nivel[l] + 1))
+            continue;
+        if(atomico) {
+            if(!__sync_bool_compare_and_swap(&c->visita[r], antiga, marca))
+                continue;
+        } else {
+            c->visita[r] = marca;
+        }
+        if(c->par[r] == NENHUM)
+            break;
+        pilha[++topo] = c->par[r];
+        c->iter[c->par[r]] = c->ini[c->par[r]];
+    }
+    // Inverte o caminho: cada vertice da pilha fica com o ultimo vizinho que
+    // tentou.
+    CONTA(aumentos, 1);
+    for(;;) {
+        l = pilha[topo];
+        r = c->adj[c->iter[l] - 1];
+        c->par[r] = l;
+        c->par[l] = r;
+        if(topo-- == 0)
+            return 1;
+    }
+}
+
+int monta_componentes(grafo g, struct componentes *c) {
+    unsigned int n = n_vertices(g), i, k;
+    cursor_vizinhanca cur;
+    aresta a;
+
+    memset(c, 0, sizeof(struct componentes));
+    c->n = n;
+    c->vetor = numera_ordem(g->v);
+    c->ini = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    c->par = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    c->visita = ALOCA_ZERADO(MEM_ALGORITMOS, n + 1, sizeof(unsigned int));
+    c->iter = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    c->pilha = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    c->lado = ALOCA(MEM_ALGORITMOS, n + 1);
+    if(!c->vetor || !c->ini || !c->par || !c->visita || !c->iter || !c->pilha || !c->lado)
+        return 0;
+    for(c->ini[0] = 0, i = 0; i < n; ++i)
+        c->ini[i+1] = c->ini[i] + grau(c->vetor[i], VIZIN_COMPL, g);
+    c->adj = ALOCA(MEM_ALGORITMOS, (c->ini[n] + 1) * sizeof(unsigned int));
+    c->arco = ALOCA(MEM_ALGORITMOS, (c->ini[n] + 1) * sizeof(aresta));
+    if(!c->adj || !c->arco)
+        return 0;
+    for(i = 0; i < n; ++i) {
+        c->par[i] = NENHUM;
+        c->lado[i] = c->vetor[i]->lado ? 1 : 0;
+        for(k = c->ini[i], inicia_vizinhanca(&cur, c->vetor[i], VIZIN_COMPL); (a = proxima_incidente(&cur)); ++k) {
+            c->adj[k] = (unsigned int) outra_ponta(a, c->vetor[i])->atributo;
+            c->arco[k] = a;
+        }
+    }
+    return 1;
+}
+
+grafo grava_componentes(grafo g, struct componentes *c) {
+    unsigned int i, k;
+
+    for(i = 0; i < c->n; ++i) {
+        c->vetor[i]->coberto = c->par[i] != NENHUM;
+        for(k = c->ini[i]; k < c->ini[i+1]; ++k)
+            c->arco[k]->coberta = 0;
+    }
+    for(i = 0; i < c->n; ++i) {
+        if(c->lado[i] || c->par[i] == NENHUM)
+            continue;
+        for(k = c->ini[i]; c->adj[k] != c->par[i]; ++k)
+            ;
+        c->arco[k]->coberta = 1;
+    }
+    return grafo_emparelhamento(g);
+}
+
+void libera_componentes(struct componentes *c) {
+    if(!c->externo) {
+        LIBERA(c->ini); LIBERA(c->adj); LIBERA(c->lado);
+    }
+    LIBERA(c->vetor); LIBERA(c->arco); LIBERA(c->ordem); LIBERA(c->comeco);
+    LIBERA(c->par); LIBERA(c->visita); LIBERA(c->iter); LIBERA(c->pilha); LIBERA(c->nivel);
+}
+
+void guloso_componentes(struct componentes *c) {
+    unsigned int x, k;
+
+    for(x = 0; x < c->n; ++x) {
+        if(c->lado[x] || c->par[x] != NENHUM)
+            continue;
+        for(k = c->ini[x]; k < c->ini[x+1]; ++k) {
+            if(c->par[c->adj[k]] == NENHUM) {
+                c->par[x] = c->adj[k];
+                c->par[c->adj[k]] = x;
+                break;
+            }
+        }
+    }
+}
+
+unsigned int camadas_componentes(struct componentes *c, unsigned int marca, unsigned int *livres) {
+    unsigned int ini = 0, fim = 0, x, l, k;
+
+    c->limite = NENHUM;
+    if(livres)
+        *livres = 0;
+    for(x = 0; x < c->n; ++x) {
+        c->nivel[x] = NENHUM;
+        if(c->lado[x] == 0 && c->par[x] == NENHUM) {
+            c->nivel[x] = 0;
+            c->pilha[fim++] = x;
+        }
+    }
+    // Pilha serve de fila. Nao passa da camada do primeiro vertice livre.
+    while(ini < fim) {
+        if(c->externo == 1 && ini % JANELA_EXTERNO == 0)
+            antecipa_externo(c, c->pilha + ini, fim - ini < JANELA_EXTERNO ? fim - ini : JANELA_EXTERNO);
+        x = c->pilha[ini++];
+        if(c->nivel[x] >= c->limite && livres == NULL)
+            break;
+        for(k = c->ini[x]; k < c->ini[x+1]; ++k) {
+            l = c->par[c->adj[k]];
+            if(l == NENHUM) {
+                if(c->limite == NENHUM)
+                    c->limite = c->nivel[x];
+                if(livres && c->visita[c->adj[k]] != marca) {
+                    c->visita[c->adj[k]] = marca;
+                    ++*livres;
+                }
+            } else if(c->nivel[l] == NENHUM) {
+                c->nivel[l] = c->nivel[x] + 1;
+                c->pilha[fim++] = l;
+            }
+        }
+    }
+    return c->limite;
+}
+
+void emparelha_componente(struct componentes *c, unsigned int i, unsigned int marca) {
+    unsigned int k, x, r, n0 = 0, n1 = 0, livres = 1, fim = c->comeco[i+1];
+
+    for(k = c->comeco[i]; k < fim; ++k) {
+        if(c->lado[c->ordem[k]])
+            ++n1;
+        else
+            ++n0;
+        if(c->par[c->ordem[k]] != NENHUM)
+            livres = 0;
+    }
+    if(n0 == 0 || n1 == 0)
+        return; // Vertice isolado.
+    // Caminho rapido: com um vertice so num dos lados, basta uma aresta. So
+    // vale se ninguem da componente esta emparelhado (a fase das componentes
+    // grandes ja pode ter emparelhado o vertice do lado unico).
+    if(livres && (n0 == 1 || n1 == 1)) {
+        x = c->ordem[c->comeco[i]];
+        r = c->adj[c->ini[x]];
+        c->par[x] = r;
+        c->par[r] = x;
+        return;
+    }
+    // Guloso, depois uma busca por vertice livre do lado 0.
+    for(k = c->comeco[i]; k < fim; ++k) {
+        x = c->ordem[k];
+        if(c->lado[x] || c->par[x] != NENHUM)
+            continue;
+        for(r = c->ini[x]; r < c->ini[x+1]; ++r) {
+            if(c->par[c->adj[r]] == NENHUM) {
+                c->par[x] = c->adj[r];
+                c->par[c->adj[r]] = x;
+                break;
+            }
+        }
+    }
+    for(k = c->comeco[i]; k < fim; ++k) {
+        x = c->ordem[k];
+        if(c->lado[x] == 0 && c->par[x] == NENHUM
+           && aumenta_componente(c, x, marca, c->pilha + c->comeco[i], 0))
+            ++marca;
+    }
+}
+
+void *thread_componente_grande(void *arg) {
+    struct escalonador *e = arg;
+    unsigned int id = __sync_fetch_and_add(&e->proxima_thread, 1), i;
+    unsigned int *pilha = e->pilhas + (unsigned long) id * e->tam_pilha;
+    HERDA_CONTADORES(parcial, e->contadores);
+
+    while((i = __sync_fetch_and_add(&e->proximo, 1)) < e->n_livres)
+        if(aumenta_componente(e->c, e->livres[i], e->marca, pilha, 1))
+            __sync_fetch_and_add(&e->achados, 1);
+    DEVOLVE_CONTADORES(parcial, e->contadores);
+    return NULL;
+}
+
+void *thread_componentes(void *arg) {
+    struct escalonador *e = arg;
+    unsigned int id = __sync_fetch_and_add(&e->proxima_thread, 1), j, t;
+    struct fila_tarefas *f;
+    int achou;
+    HERDA_CONTADORES(parcial, e->contadores);
+
+    for(;;) {
+        // Tira da propria fila (pelo fim) ou rouba de outra (pelo inicio).
+        for(achou = 0, j = 0; j < e->n_threads && !achou; ++j) {
+            f = &e->filas[(id + j) % e->n_threads];
+            pthread_mutex_lock(&f->trava);
+            if(f->ini < f->fim) {
+                t = j == 0 ? f->tarefa[--f->fim] : f->tarefa[f->ini++];
+                achou = 1;
+            }
+            pthread_mutex_unlock(&f->trava);
+        }
+        if(!achou)
+            break; // Nenhuma tarefa nova eh criada: acabou.
+        emparelha_componente(e->c, t, 1);
+    }
+    DEVOLVE_CONTADORES(parcial, e->contadores);
+    return NULL;
+}
+
+int compara_componentes(const void *a, const void *b) {
+    const unsigned int *x = a, *y = b;
+
+    // x[0] = tamanho, x[1] = componente.
+    return x[0] < y[0] ? 1 : x[0] > y[0] ? -1 : 0;
+}
+
+grafo emparelhamento_componentes(grafo g, unsigned int n_threads) {
+    /* Separa g em componentes conexas (busca em largura) e emparelha cada uma
+     * independentemente. As componentes com COMPONENTE_GRANDE vertices ou
+     * mais usam todas as threads: em cada fase, as threads fazem buscas em
+     * profundidade simultaneas a partir dos vertices livres, disputando os
+     * vertices com marcacao atomica (Pothen-Fan); quando uma fase nao acha
+     * nada, uma passada sequencial garante que o emparelhamento eh maximo.
+     * As demais sao distribuidas, da maior pra menor, em filas por thread
+     * com roubo de trabalho. */
+    if(g == NULL)
+        return NULL;
+    if(!bipartido(g, NULL))
+        return NULL;
+
+    unsigned int n, i, j, k, x, y, fim, criadas;
+    unsigned int *tam = NULL;
+    struct componentes c;
+    struct escalonador e;
+    pthread_t *threads = NULL;
+    grafo emp = NULL;
+
+    memset(&e, 0, sizeof(struct escalonador));
+    e.c = &c;
+    e.contadores = CONTADORES_ATIVOS;
+    e.n_threads = n_threads ? n_threads : 1;
+    threads = ALOCA(MEM_ALGORITMOS, e.n_threads * sizeof(pthread_t));
+    e.filas = ALOCA_ZERADO(MEM_ALGORITMOS, e.n_threads, sizeof(struct fila_tarefas));
+    if(!monta_componentes(g, &c) || !threads || !e.filas
+       || !(c.ordem = ALOCA(MEM_ALGORITMOS, (c.n + 1) * sizeof(unsigned int)))
+       || !(c.comeco = ALOCA(MEM_ALGORITMOS, (c.n + 2) * sizeof(unsigned int)))) {
+        perror("(emparelhamento_componentes) Erro ao allocar memoria.");
+        goto fim;
+    }
+    n = c.n;
+
+    // Componentes por busca em largura (par[] serve de "ja visto" aqui).
+    for(fim = 0, i = 0; i < n; ++i) {
+        if(c.par[i] != NENHUM)
+            continue;
+        c.comeco[c.n_comp++] = fim;
+        c.par[i] = 0;
+        c.ordem[fim++] = i;
+        for(j = c.comeco[c.n_comp - 1]; j < fim; ++j) {
+            x = c.ordem[j];
+            for(k = c.ini[x]; k < c.ini[x+1]; ++k) {
+                y = c.adj[k];
+                if(c.par[y] == NENHUM) {
+                    c.par[y] = 0;
+                    c.ordem[fim++] = y;
+                }
+            }
+        }
+    }
+    c.comeco[c.n_comp] = fim;
+    for(i = 0; i < n; ++i)
+        c.par[i] = NENHUM;
+
+    // Ordena as componentes da maior pra menor.
+    tam = ALOCA(MEM_ALGORITMOS, (2 * c.n_comp + 1) * sizeof(unsigned int));
+    for(i = 0; i < e.n_threads; ++i)
+        e.filas[i].tarefa = ALOCA(MEM_ALGORITMOS, (c.n_comp / e.n_threads + 1) * sizeof(unsigned int));
+    for(i = 0; i < e.n_threads; ++i)
+        if(e.filas[i].tarefa == NULL) {
+            LIBERA(tam);
+            tam = NULL;
+        }
+    if(tam == NULL) {
+        perror("(emparelhamento_componentes) Erro ao allocar memoria.");
+        goto fim;
+    }
+    for(i = 0; i < c.n_comp; ++i) {
+        tam[2*i] = c.comeco[i+1] - c.comeco[i];
+        tam[2*i+1] = i;
+    }
+    qsort(tam, c.n_comp, 2 * sizeof(unsigned int), compara_componentes);
+
+    // Componentes grandes: todas as threads em cada uma.
+    for(i = 0; i < c.n_comp && e.n_threads > 1 && tam[2*i] >= COMPONENTE_GRANDE; ++i) {
+        x = tam[2*i+1];
+        if(e.pilhas == NULL) {
+            e.tam_pilha = tam[2*i];
+            e.pilhas = ALOCA(MEM_ALGORITMOS, (unsigned long) e.n_threads * e.tam_pilha * sizeof(unsigned int));
+            if(e.pilhas == NULL) {
+                perror("(emparelhamento_componentes) Erro ao allocar memoria.");
+                goto fim;
+            }
+        }
+        e.livres = c.pilha + c.comeco[x];
+        for(e.marca = 1; ; ++e.marca) {
+            for(e.n_livres = 0, k = c.comeco[x]; k < c.comeco[x+1]; ++k)
+                if(c.lado[c.ordem[k]] == 0 && c.par[c.ordem[k]] == NENHUM)
+                    e.livres[e.n_livres++] = c.ordem[k];
+            e.proximo = e.achados = e.proxima_thread = 0;
+            for(criadas = 0; criadas < e.n_threads; ++criadas)
+                if(pthread_create(&threads[criadas], NULL, thread_componente_grande, &e))
+                    break;
+            if(criadas == 0)
+                thread_componente_grande(&e);
+            for(j = 0; j < criadas; ++j)
+                pthread_join(threads[j], NULL);
+            if(e.achados == 0)
+                break;
+        }
+        // Buscas simultaneas podem se bloquear: termina sequencialmente.
+        emparelha_componente(&c, x, e.marca + 1);
+    }
+
+    // Demais componentes: distribui em rodizio e deixa as threads roubarem.
+    for(j = 0; i < c.n_comp; ++i, j = (j + 1) % e.n_threads)
+        e.filas[j].tarefa[e.filas[j].fim++] = tam[2*i+1];
+    for(j = 0; j < e.n_threads; ++j)
+        pthread_mutex_init(&e.filas[j].trava, NULL);
+    e.proxima_thread = 0;
+    for(criadas = 0; criadas + 1 < e.n_threads; ++criadas)
+        if(pthread_create(&threads[criadas], NULL, thread_componentes, &e))
+            break;
+    thread_componentes(&e);
+    for(j = 0; j < criadas; ++j)
+        pthread_join(threads[j], NULL);
+    for(j = 0; j < e.n_threads; ++j)
+        pthread_mutex_destroy(&e.filas[j].trava);
+
+    // Junta tudo num emparelhamento so.
+    emp = grava_componentes(g, &c);
+
+fim:
+    if(e.filas)
+        for(i = 0; i < e.n_threads; ++i)
+            LIBERA(e.filas[i].tarefa);
+    LIBERA(e.filas); LIBERA(e.pilhas); LIBERA(threads); LIBERA(tam);
+    libera_componentes(&c);
+    return emp;
+}
+
+double hopcroft_karp(struct componentes *c, double epsilon) {
+    unsigned int x, l, marca = 1;
+
+    guloso_componentes(c);
+    while((l = camadas_componentes(c, 0, NULL)) != NENHUM && (double) l / (l + 1) < 1 - epsilon) {
+        CONTA(fases_camadas, 1);
+        for(x = 0; x < c->n; ++x)
+            if(c->nivel[x] == 0 && c->par[x] == NENHUM)
+                aumenta_componente(c, x, marca, c->pilha, 0);
+        ++marca;
+    }
+    return l == NENHUM ? 1 : (double) l / (l + 1);
+}
+
+grafo emparelhamento_aproximado(grafo g, double epsilon, double *razao) {
+    /* Hopcroft-Karp interrompido. Se o menor caminho aumentante tem L
+     * arestas do emparelhamento M, a diferenca simetrica entre M e um
+     * emparelhamento maximo M* tem |M*| - |M| caminhos aumentantes
+     * disjuntos, cada um com pelo menos L arestas de M, entao
+     * |M| >= L (|M*| - |M|), ou seja, |M| / |M*| >= L / (L + 1). Cada fase
+     * aumenta L, entao basta O(1/epsilon) fases. */
+    if(g == NULL)
+        return NULL;
+    if(!bipartido(g, NULL))
+        return NULL;
+
+    struct componentes c;
+    grafo emp = NULL;
+    double r;
+
+    if(!monta_componentes(g, &c) || !(c.nivel = ALOCA(MEM_ALGORITMOS, (c.n + 1) * sizeof(unsigned int)))) {
+        perror("(emparelhamento_aproximado) Erro ao allocar memoria.");
+        libera_componentes(&c);
+        return NULL;
+    }
+    r = hopcroft_karp(&c, epsilon);
+    if(razao)
+        *razao = r;
+    emp = grava_componentes(g, &c);
+    libera_componentes(&c);
+    return emp;
+}
+
+int le_aresta_passadas(FILE *f, char *u, char *v) {
+    char linha[4 * TAM_NOME], resto[TAM_NOME];
+    int c, k;
+
+    while(fgets(linha, sizeof(linha), f)) {
+        // Descarta o que passar do tamanho da linha.
+        if(strchr(linha, '\n') == NULL)
+            while((c = getc(f)) != EOF && c != '\n')
+                ;
+        k = sscanf(linha, "%" TEXTO_DE(MAX_NOME) "s %" TEXTO_DE(MAX_NOME) "s %" TEXTO_DE(MAX_NOME) "s", u, v, resto);
+        if(k < 2 || u[0] == '#')
+            continue;
+        if(strcmp(v, "--") == 0 || strcmp(v, "->") == 0) {
+            if(k < 3)
+                continue;
+            strcpy(v, resto);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+unsigned int id_passadas(struct passadas *p, const char *nome, int cria) {
+    unsigned int h = 2166136261u, i, x, *tabela, cap;
+    const char *c;
+    void *novo;
+
+    for(c = nome; *c; ++c)
+        h = (h ^ (unsigned char) *c) * 16777619u;
+    for(i = h & (p->tam_tabela - 1); p->tabela[i] != NENHUM; i = (i + 1) & (p->tam_tabela - 1))
+        if(strcmp(p->nome[p->tabela[i]], nome) == 0)
+            return p->tabela[i];
+    if(!cria)
+        return NENHUM;
+    if(p->n == p->capacidade) {
+        cap = 2 * p->capacidade;
+        if(!(novo = REALOCA(MEM_ALGORITMOS, p->nome, cap * sizeof(*p->nome))))
+            return NENHUM;
+        p->nome = novo;
+        if(!(novo = REALOCA(MEM_ALGORITMOS, p->uf, cap * sizeof(unsigned int))))
+            return NENHUM;
+        p->uf = novo;
+        if(!(novo = REALOCA(MEM_ALGORITMOS, p->par, cap * sizeof(unsigned int))))
+            return NENHUM;
+        p->par = novo;
+        if(!(novo = REALOCA(MEM_ALGORITMOS, p->paridade, cap)))
+            return NENHUM;
+        p->paridade = novo;
+        p->capacidade = cap;
+    }
+    x = p->n++;
+    strncpy(p->nome[x], nome, TAM_NOME - 1);
+    p->nome[x][TAM_NOME - 1] = '\0';
+    p->uf[x] = x;
+    p->par[x] = NENHUM;
+    p->paridade[x] = 0;
+    p->tabela[i] = x;
+    // Mantem a tabela no maximo meio cheia.
+    if(2 * p->n > p->tam_tabela) {
+        if(!(tabela = ALOCA(MEM_ALGORITMOS, 2 * p->tam_tabela * sizeof(unsigned int))))
+            return NENHUM;
+        LIBERA(p->tabela);
+        p->tabela = tabela;
+        p->tam_tabela *= 2;
+        memset(tabela, 0xff, p->tam_tabela * sizeof(unsigned int));
+        for(x = 0; x < p->n; ++x) {
+            for(h = 2166136261u, c = p->nome[x]; *c; ++c)
+                h = (h ^ (unsigned char) *c) * 16777619u;
+            for(i = h & (p->tam_tabela - 1); tabela[i] != NENHUM; i = (i + 1) & (p->tam_tabela - 1))
+                ;
+            tabela[i] = x;
+        }
+        x = p->n - 1;
+    }
+    return x;
+}
+
+unsigned int raiz_passadas(struct passadas *p, unsigned int x, unsigned char *paridade) {
+    unsigned int r, y;
+    unsigned char q, t;
+
+    for(r = x, q = 0; p->uf[r] != r; r = p->uf[r])
+        q ^= p->paridade[r];
+    *paridade = q;
+    // Compressao de caminho: cada vertice passa a apontar pra raiz.
+    for(; x != r; x = y, q = t) {
+        y = p->uf[x];
+        t = q ^ p->paridade[x];
+        p->uf[x] = r;
+        p->paridade[x] = q;
+    }
+    return r;
+}
+
+int inicia_passadas(struct passadas *p) {
+    memset(p, 0, sizeof(struct passadas));
+    p->capacidade = 1024;
+    p->tam_tabela = 4096;
+    p->nome = ALOCA(MEM_ALGORITMOS, p->capacidade * sizeof(*p->nome));
+    p->uf = ALOCA(MEM_ALGORITMOS, p->capacidade * sizeof(unsigned int));
+    p->par = ALOCA(MEM_ALGORITMOS, p->capacidade * sizeof(unsigned int));
+    p->paridade = ALOCA(MEM_ALGORITMOS, p->capacidade);
+    p->tabela = ALOCA(MEM_ALGORITMOS, p->tam_tabela * sizeof(unsigned int));
+    if(!p->nome || !p->uf || !p->par || !p->paridade || !p->tabela)
+        return 0;
+    memset(p->tabela, 0xff, p->tam_tabela * sizeof(unsigned int));
+    return 1;
+}
+
+grafo grafo_pares(unsigned int n, const unsigned int *par, const char *nomes) {
+    char nome[TAM_NOME];
+    vertice *copia;
+    unsigned int x;
+    grafo emp;
+
+    if(!(copia = ALOCA_ZERADO(MEM_ALGORITMOS, n + 1, sizeof(vertice))))
+        return NULL;
+    if(!(emp = constroi_grafo())) {
+        LIBERA(copia);
+        return NULL;
+    }
+    strcpy(emp->nome, "Max Matching");
+    for(x = 0; x < n; ++x) {
+        if(par[x] != NENHUM) {
+            memcpy(nome, nomes + (size_t) x * TAM_NOME, TAM_NOME);
+            nome[TAM_NOME - 1] = '\0';
+            copia[x] = insere_vertice(emp, nome);
+        }
+    }
+    for(x = 0; x < n; ++x)
+        if(par[x] != NENHUM && x < par[x])
+            insere_aresta(emp, copia[x], copia[par[x]], PESO_DEFAULT);
+    LIBERA(copia);
+    return emp;
+}
+
+int le_lados_passadas(struct passadas *p, FILE *f, int guloso) {
+    char nu[TAM_NOME], nv[TAM_NOME];
+    unsigned int u, v, ru, rv;
+    unsigned char pu, pv;
+    int bip = 1;
+
+    while(le_aresta_passadas(f, nu, nv)) {
+        if((u = id_passadas(p, nu, 1)) == NENHUM || (v = id_passadas(p, nv, 1)) == NENHUM)
+            return -1;
+        if(u == v)
+            continue;
+        if(guloso && p->par[u] == NENHUM && p->par[v] == NENHUM) {
+            p->par[u] = v;
+            p->par[v] = u;
+        }
+        ru = raiz_passadas(p, u, &pu);
+        rv = raiz_passadas(p, v, &pv);
+        if(ru != rv) {
+            p->uf[ru] = rv;
+            p->paridade[ru] = pu ^ pv ^ 1;
+        } else if(pu == pv) {
+            bip = 0;
+        }
+    }
+    return bip;
+}
+
+int prepara_camadas_passadas(struct passadas *p) {
+    unsigned int x;
+    unsigned char q;
+
+    p->nivel = ALOCA(MEM_ALGORITMOS, (p->n + 1) * sizeof(unsigned int));
+    p->pai = ALOCA(MEM_ALGORITMOS, (p->n + 1) * sizeof(unsigned int));
+    p->fins = ALOCA(MEM_ALGORITMOS, (p->n + 1) * sizeof(unsigned int));
+    p->usado = ALOCA_ZERADO(MEM_ALGORITMOS, p->n + 1, sizeof(unsigned int));
+    if(!p->nivel || !p->pai || !p->fins || !p->usado)
+        return 0;
+    // Lado de cada vertice = paridade em relacao a raiz. Passa por q porque
+    // raiz_passadas ainda le p->paridade[x] depois de escrever a saida.
+    for(x = 0; x < p->n; ++x) {
+        raiz_passadas(p, x, &q);
+        p->paridade[x] = q;
+    }
+    return 1;
+}
+
+void inicia_fase_passadas(struct passadas *p) {
+    unsigned int x;
+
+    for(x = 0; x < p->n; ++x) {
+        p->nivel[x] = p->pai[x] = NENHUM;
+        if(p->paridade[x] == 0 && p->par[x] == NENHUM)
+            p->nivel[x] = 0;
+    }
+}
+
+void expande_passadas(struct passadas *p, unsigned int l, unsigned int r, unsigned int d,
+                      unsigned int *n_fins, unsigned int *novos) {
+    CONTA(arestas_examinadas, 1);
+    if(p->nivel[l] != d || p->pai[r] != NENHUM)
+        return;
+    p->pai[r] = l;
+    if(p->par[r] == NENHUM)
+        p->fins[(*n_fins)++] = r;
+    else if(p->nivel[p->par[r]] == NENHUM) {
+        p->nivel[p->par[r]] = d + 1;
+        ++*novos;
+    }
+}
+
+void aumenta_passadas(struct passadas *p, unsigned int n_fins, unsigned int fase) {
+    unsigned int x, l = NENHUM, r, prox;
+    int livre;
+
+    for(x = 0; x < n_fins; ++x) {
+        // Sem pai (lados inconsistentes) o caminho nao chega a um vertice
+        // livre do lado 0; para antes de ler fora dos vetores.
+        CONTA(buscas, 1);
+        for(livre = 1, r = p->fins[x]; r != NENHUM; r = p->par[l]) {
+            l = p->pai[r];
+            if(l == NENHUM || p->usado[l] == fase) {
+                livre = 0;
+                break;
+            }
+        }
+        if(!livre)
+            continue;
+        CONTA(aumentos, 1);
+        for(r = p->fins[x]; r != NENHUM; r = prox) {
+            l = p->pai[r];
+            p->usado[l] = fase;
+            prox = p->par[l];
+            p->par[l] = r;
+            p->par[r] = l;
+        }
+    }
+}
+
+void libera_passadas(struct passadas *p) {
+    LIBERA(p->nome); LIBERA(p->tabela); LIBERA(p->par); LIBERA(p->uf); LIBERA(p->nivel);
+    LIBERA(p->pai); LIBERA(p->fins); LIBERA(p->usado); LIBERA(p->paridade);
+}
+
+grafo emparelhamento_em_passadas(FILE *arestas, double epsilon, double *razao, unsigned int *passadas) {
+    /* Passada 1: numera os vertices, calcula os lados (union-find com
+     * paridade) e monta um emparelhamento maximal guloso. Se o grafo nao eh
+     * bipartido, para ai (o maximal tem pelo menos metade do maximo). Senao,
+     * cada fase eh uma busca em largura de Hopcroft-Karp feita uma camada por
+     * passada, seguida do aumento por caminhos disjuntos da floresta da
+     * busca. Se o menor caminho aumentante tem L arestas do emparelhamento,
+     * a razao eh pelo menos L / (L + 1) (ver emparelhamento_aproximado);
+     * com epsilon <= 0 vai ate o maximo. */
+    if(arestas == NULL)
+        return NULL;
+
+    struct passadas p;
+    char nu[TAM_NOME], nv[TAM_NOME];
+    unsigned int u, v, d, n_fins, novos, fase = 0, n_passadas = 0;
+    int bip;
+    double garantia = 0.5;
+    grafo emp = NULL;
+
+    if(!inicia_passadas(&p))
+        goto erro_memoria;
+
+    if(fseek(arestas, 0, SEEK_SET) != 0) {
+        perror("(emparelhamento_em_passadas) O arquivo de arestas precisa permitir varias leituras.");
+        goto fim;
+    }
+    ++n_passadas;
+    if((bip = le_lados_passadas(&p, arestas, 1)) < 0)
+        goto erro_memoria;
+
+    if(bip) {
+        if(!prepara_camadas_passadas(&p))
+            goto erro_memoria;
+        garantia = 1;
+        for(;;) {
+            inicia_fase_passadas(&p);
+            // Uma camada por passada, ate achar vertice livre do lado 1.
+            for(d = 0, n_fins = 0; ; ++d) {
+                rewind(arestas);
+                for(++n_passadas, novos = 0; le_aresta_passadas(arestas, nu, nv); ) {
+                    u = id_passadas(&p, nu, 0);
+                    v = id_passadas(&p, nv, 0);
+                    if(u == v)
+                        continue;
+                    if(p.paridade[u])
+                        expande_passadas(&p, v, u, d, &n_fins, &novos);
+                    else
+                        expande_passadas(&p, u, v, d, &n_fins, &novos);
+                }
+                if(n_fins || !novos || (double) (d + 1) / (d + 2) >= 1 - epsilon)
+                    break;
+            }
+            if(n_fins == 0 && !novos)
+                break; // Nao ha caminho aumentante: maximo.
+            if(n_fins == 0 || (double) d / (d + 1) >= 1 - epsilon) {
+                garantia = n_fins ? (double) d / (d + 1) : (double) (d + 1) / (d + 2);
+                break;
+            }
+            // Aumenta por caminhos da floresta que nao se cruzam.
+            CONTA(fases_camadas, 1);
+            aumenta_passadas(&p, n_fins, ++fase);
+        }
+    }
+
+    if(!(emp = grafo_pares(p.n, p.par, (const char *) p.nome)))
+        goto erro_memoria;
+    if(razao)
+        *razao = garantia;
+    if(passadas)
+        *passadas = n_passadas;
+    goto fim;
+
+erro_memoria:
+    perror("(emparelhamento_em_passadas) Erro ao allocar memoria.");
+fim:
+    libera_passadas(&p);
+    return emp;
+}
+
+void desloca_externo(unsigned int n, unsigned int arcos, size_t *desl) {
+    desl[0] = sizeof(struct cabecalho_externo);
+    desl[1] = desl[0] + ((size_t) n + 1) * sizeof(unsigned int);
+    desl[2] = (desl[1] + n + 7) / 8 * 8;
+    desl[3] = (desl[2] + (size_t) n * TAM_NOME + PAGINA_EXTERNO - 1) / PAGINA_EXTERNO * PAGINA_EXTERNO;
+    desl[4] = desl[3] + (size_t) arcos * sizeof(unsigned int);
+}
+
+void antecipa_externo(struct componentes *c, const unsigned int *fila, unsigned int n) {
+    size_t pagina = (size_t) sysconf(_SC_PAGESIZE), ini = 0, fim = 0, a, b;
+    size_t base = (size_t) c->adj;
+    unsigned int i, x;
+    int erro = 0;
+
+    // Adj so esta alinhada em PAGINA_EXTERNO, que pode ser menor que a
+    // pagina do sistema: os limites sao arredondados nos enderecos mesmo.
+    // O mapeamento comeca numa pagina e termina no fim de uma, entao os
+    // arredondamentos nao saem dele.
+    for(i = 0; i < n && !erro; ++i) {
+        x = fila[i];
+        if(c->ini[x] == c->ini[x+1])
+            continue;
+        a = (base + (size_t) c->ini[x] * sizeof(unsigned int)) / pagina * pagina;
+        b = (base + (size_t) c->ini[x+1] * sizeof(unsigned int) + pagina - 1) / pagina * pagina;
+        if(fim > ini && a <= fim && b >= ini) {
+            ini = a < ini ? a : ini;
+            fim = b > fim ? b : fim;
+            continue;
+        }
+        if(fim > ini)
+            erro = posix_madvise((void *) ini, fim - ini, POSIX_MADV_WILLNEED);
+        ini = a;
+        fim = b;
+    }
+    if(!erro && fim > ini)
+        erro = posix_madvise((void *) ini, fim - ini, POSIX_MADV_WILLNEED);
+    if(erro) {
+        // So um aviso: sem antecipar, a busca fica mais lenta, mas certa.
+        errno = erro;
+        perror("(antecipa_externo) Erro ao antecipar paginas do grafo.");
+        c->externo = 2;
+    }
+}
+
+grafo_externo constroi_grafo_externo(FILE *arestas, const char *arquivo) {
+    /* Tres leituras de arestas: nomes, graus e adjacencia (num arquivo
+     * temporario, na numeracao da leitura). Depois, uma busca em largura
+     * sobre o temporario da a nova numeracao e os lados, e o arquivo final
+     * eh escrito sequencialmente nessa ordem. So vetores por vertice ficam
+     * na memoria. */
+    if(arestas == NULL || arquivo == NULL)
+        return NULL;
+
+    struct passadas p;
+    struct cabecalho_externo cab;
+    char nu[TAM_NOME], nv[TAM_NOME];
+    unsigned int u, v, x, y, i, j, k, arcos = 0, fim, bip = 1;
+    unsigned int *ini = NULL, *pos = NULL, *ordem = NULL, *novo = NULL, *adj = NULL, *saida;
+    unsigned char *lado = NULL, *mapa = NULL;
+    size_t desl[5], tam_tmp = 0;
+    FILE *tmp = NULL;
+    int fd = -1;
+    grafo_externo ge = NULL;
+
+    if(!inicia_passadas(&p))
+        goto erro_memoria;
+    if(fseek(arestas, 0, SEEK_SET) != 0) {
+        perror("(constroi_grafo_externo) O arquivo de arestas precisa permitir varias leituras.");
+        goto fim;
+    }
+    while(le_aresta_passadas(arestas, nu, nv))
+        if(id_passadas(&p, nu, 1) == NENHUM || id_passadas(&p, nv, 1) == NENHUM)
+            goto erro_memoria;
+    ini = ALOCA_ZERADO(MEM_ES, p.n + 1, sizeof(unsigned int));
+    pos = ALOCA(MEM_ES, (p.n + 1) * sizeof(unsigned int));
+    ordem = ALOCA(MEM_ES, (p.n + 1) * sizeof(unsigned int));
+    novo = ALOCA(MEM_ES, (p.n + 1) * sizeof(unsigned int));
+    lado = ALOCA(MEM_ES, p.n + 1);
+    if(!ini || !pos || !ordem || !novo || !lado)
+        goto erro_memoria;
+    // Graus (ini[x+1] conta os vizinhos de x).
+    rewind(arestas);
+    while(le_aresta_passadas(arestas, nu, nv)) {
+        u = id_passadas(&p, nu, 0);
+        v = id_passadas(&p, nv, 0);
+        if(u == v)
+            continue;
+        ++ini[u+1];
+        ++ini[v+1];
+        if((arcos += 2) < 2) {
+            perror("(constroi_grafo_externo) Arestas demais.");
+            goto fim;
+        }
+    }
+    for(x = 0; x < p.n; ++x)
+        ini[x+1] += ini[x];
+    // Adjacencia temporaria.
+    tam_tmp = (size_t) arcos * sizeof(unsigned int) + 1;
+    if(!(tmp = tmpfile()) || ftruncate(fileno(tmp), (off_t) tam_tmp) != 0
+       || (adj = mmap(NULL, tam_tmp, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(tmp), 0)) == MAP_FAILED) {
+        adj = NULL;
+        perror("(constroi_grafo_externo) Erro ao criar arquivo temporario.");
+        goto fim;
+    }
+    memcpy(pos, ini, p.n * sizeof(unsigned int));
+    rewind(arestas);
+    while(le_aresta_passadas(arestas, nu, nv)) {
+        u = id_passadas(&p, nu, 0);
+        v = id_passadas(&p, nv, 0);
+        if(u == v)
+            continue;
+        adj[pos[u]++] = v;
+        adj[pos[v]++] = u;
+    }
+    // Nova numeracao (busca em largura) e lados.
+    for(x = 0; x < p.n; ++x)
+        novo[x] = NENHUM;
+    for(fim = 0, x = 0; x < p.n; ++x) {
+        if(novo[x] != NENHUM)
+            continue;
+        novo[x] = fim;
+        lado[x] = 0;
+        ordem[fim++] = x;
+        for(i = novo[x]; i < fim; ++i) {
+            y = ordem[i];
+            for(k = ini[y]; k < ini[y+1]; ++k) {
+                if(novo[adj[k]] == NENHUM) {
+                    novo[adj[k]] = fim;
+                    lado[adj[k]] = !lado[y];
+                    ordem[fim++] = adj[k];
+                } else if(lado[adj[k]] == lado[y]) {
+                    bip = 0;
+                }
+            }
+        }
+    }
+    // Arquivo final.
+    desloca_externo(p.n, arcos, desl);
+    if((fd = open(arquivo, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0 || ftruncate(fd, (off_t) desl[4]) != 0
+       || (mapa = mmap(NULL, desl[4], PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+        mapa = NULL;
+        perror("(constroi_grafo_externo) Erro ao criar o arquivo do grafo.");
+        goto fim;
+    }
+    memset(&cab, 0, sizeof(struct cabecalho_externo));
+    memcpy(cab.magica, "GRAFOEXT", 8);
+    cab.n = p.n;
+    cab.arcos = arcos;
+    cab.bipartido = bip;
+    memcpy(mapa, &cab, sizeof(struct cabecalho_externo));
+    saida = (unsigned int *) (mapa + desl[0]);
+    for(saida[0] = 0, i = 0; i < p.n; ++i)
+        saida[i+1] = saida[i] + ini[ordem[i]+1] - ini[ordem[i]];
+    for(i = 0; i < p.n; ++i) {
+        mapa[desl[1] + i] = lado[ordem[i]];
+        memcpy(mapa + desl[2] + (size_t) i * TAM_NOME, p.nome[ordem[i]], TAM_NOME);
+    }
+    for(j = 0, i = 0; i < p.n; ++i)
+        for(k = ini[ordem[i]]; k < ini[ordem[i]+1]; ++k)
+            ((unsigned int *) (mapa + desl[3]))[j++] = novo[adj[k]];
+    if(msync(mapa, desl[4], MS_SYNC) != 0) {
+        perror("(constroi_grafo_externo) Erro ao gravar o arquivo do grafo.");
+        goto fim;
+    }
+    munmap(mapa, desl[4]);
+    mapa = NULL;
+    ge = abre_grafo_externo(arquivo);
+    goto fim;
+
+erro_memoria:
+    perror("(constroi_grafo_externo) Erro ao allocar memoria.");
+fim:
+    if(mapa)
+        munmap(mapa, desl[4]);
+    if(fd >= 0)
+        close(fd);
+    if(adj)
+        munmap(adj, tam_tmp);
+    if(tmp)
+        fclose(tmp);
+    LIBERA(ini); LIBERA(pos); LIBERA(ordem); LIBERA(novo); LIBERA(lado);
+    libera_passadas(&p);
+    return ge;
+}
+
+grafo_externo abre_grafo_externo(const char *arquivo) {
+    struct cabecalho_externo cab;
+    struct stat st;
+    size_t desl[5];
+    grafo_externo ge;
+
+    if(arquivo == NULL)
+        return NULL;
+    if(!(ge = ALOCA_ZERADO(MEM_ES, 1, sizeof(struct grafo_externo)))) {
+        perror("(abre_grafo_externo) Erro ao allocar memoria.");
+        return NULL;
+    }
+    if((ge->fd = open(arquivo, O_RDONLY)) < 0 || fstat(ge->fd, &st) != 0
+       || (size_t) st.st_size < sizeof(struct cabecalho_externo)) {
+        perror("(abre_grafo_externo) Erro ao abrir o arquivo do grafo.");
+        destroi_grafo_externo(ge);
+        return NULL;
+    }
+    ge->tamanho = (size_t) st.st_size;
+    if((ge->mapa = mmap(NULL, ge->tamanho, PROT_READ, MAP_SHARED, ge->fd, 0)) == MAP_FAILED) {
+        ge->mapa = NULL;
+        perror("(abre_grafo_externo) Erro ao mapear o arquivo do grafo.");
+        destroi_grafo_externo(ge);
+        return NULL;
+    }
+    memcpy(&cab, ge->mapa, sizeof(struct cabecalho_externo));
+    desloca_externo(cab.n, cab.arcos, desl);
+    if(memcmp(cab.magica, "GRAFOEXT", 8) != 0 || desl[4] != ge->tamanho) {
+        perror("(abre_grafo_externo) O arquivo nao eh um grafo externo.");
+        destroi_grafo_externo(ge);
+        return NULL;
+    }
+    ge->n = cab.n;
+    ge->bipartido = cab.bipartido;
+    ge->ini = (unsigned int *) (ge->mapa + desl[0]);
+    ge->lado = ge->mapa + desl[1];
+    ge->nome = (const char *) (ge->mapa + desl[2]);
+    ge->adj = (unsigned int *) (ge->mapa + desl[3]);
+    // Quem le adiante eh a busca em largura (ver antecipa_externo).
+    posix_madvise(ge->mapa, ge->tamanho, POSIX_MADV_RANDOM);
+    return ge;
+}
+
+int destroi_grafo_externo(grafo_externo ge) {
+    if(ge == NULL)
+        return 0;
+    if(ge->mapa)
+        munmap(ge->mapa, ge->tamanho);
+    if(ge->fd >= 0)
+        close(ge->fd);
+    LIBERA(ge);
+    return 1;
+}
+
+unsigned int n_vertices_externo(grafo_externo ge) {
+    return ge->n;
+}
+
+const char *nome_vertice_externo(grafo_externo ge, unsigned int x) {
+    return ge->nome + (size_t) x * TAM_NOME;
+}
+
+unsigned int vizinhos_externo(grafo_externo ge, unsigned int x, const unsigned int **vizinhos) {
+    *vizinhos = ge->adj + ge->ini[x];
+    return ge->ini[x+1] - ge->ini[x];
+}
+
+grafo emparelhamento_externo(grafo_externo ge, double epsilon, double *razao) {
+    /* O mesmo Hopcroft-Karp de emparelhamento_aproximado, com a adjacencia
+     * lida direto do mapa; na memoria ficam so os vetores por vertice. */
+    if(ge == NULL)
+        return NULL;
+    if(!ge->bipartido)
+        return NULL;
+
+    struct componentes c;
+    unsigned int x;
+    grafo emp = NULL;
+    double r;
+
+    memset(&c, 0, sizeof(struct componentes));
+    c.externo = 1;
+    c.n = ge->n;
+    c.ini = ge->ini;
+    c.adj = ge->adj;
+    c.lado = ge->lado;
+    c.par = ALOCA(MEM_ALGORITMOS, (c.n + 1) * sizeof(unsigned int));
+    c.visita = ALOCA_ZERADO(MEM_ALGORITMOS, c.n + 1, sizeof(unsigned int));
+    c.iter = ALOCA(MEM_ALGORITMOS, (c.n + 1) * sizeof(unsigned int));
+    c.pilha = ALOCA(MEM_ALGORITMOS, (c.n + 1) * sizeof(unsigned int));
+    c.nivel = ALOCA(MEM_ALGORITMOS, (c.n + 1) * sizeof(unsigned int));
+    if(!c.par || !c.visita || !c.iter || !c.pilha || !c.nivel) {
+        perror("(emparelhamento_externo) Erro ao allocar memoria.");
+        libera_componentes(&c);
+        return NULL;
+    }
+    for(x = 0; x < c.n; ++x)
+        c.par[x] = NENHUM;
+    r = hopcroft_karp(&c, epsilon);
+    if(razao)
+        *razao = r;
+    if(!(emp = grafo_pares(c.n, c.par, ge->nome)))
+        perror("(emparelhamento_externo) Erro ao allocar memoria.");
+    libera_componentes(&c);
+    return emp;
+}
+
+int envia_local(transporte *t, unsigned int parte, const unsigned int *dados, unsigned int n) {
+    struct transporte_local *l = t->dados;
+    const char *b = (const char *) dados;
+    size_t falta = (size_t) n * sizeof(unsigned int);
+    ssize_t k;
+
+    while(falta > 0) {
+        if((k = send(l->fd[parte], b, falta, MSG_NOSIGNAL)) <= 0)
+            return 0;
+        b += k;
+        falta -= (size_t) k;
+    }
+    return 1;
+}
+
+int recebe_local(transporte *t, unsigned int parte, unsigned int *dados, unsigned int n) {
+    struct transporte_local *l = t->dados;
+    char *b = (char *) dados;
+    size_t falta = (size_t) n * sizeof(unsigned int);
+    ssize_t k;
+
+    while(falta > 0) {
+        if((k = recv(l->fd[parte], b, falta, 0)) <= 0)
+            return 0;
+        b += k;
+        falta -= (size_t) k;
+    }
+    return 1;
+}
+
+int cria_transporte_local(transporte *t, unsigned int n_partes) {
+    struct transporte_local *l, filho;
+    transporte tf;
+    int par_fd[2], fd;
+    unsigned int i, j;
+
+    if(!(l = ALOCA_ZERADO(MEM_ES, 1, sizeof(struct transporte_local)))
+       || !(l->fd = ALOCA(MEM_ES, n_partes * sizeof(int))) || !(l->pid = ALOCA(MEM_ES, n_partes * sizeof(pid_t)))) {
+        if(l)
+            LIBERA(l->fd);
+        LIBERA(l);
+        return 0;
+    }
+    t->envia = envia_local;
+    t->recebe = recebe_local;
+    t->dados = l;
+    for(i = 0; i < n_partes; ++i) {
+        if(socketpair(AF_UNIX, SOCK_STREAM, 0, par_fd) != 0)
+            break;
+        if((l->pid[i] = fork()) < 0) {
+            close(par_fd[0]);
+            close(par_fd[1]);
+            break;
+        }
+        if(l->pid[i] == 0) {
+            // Processo da parte: so fica com o proprio socket.
+            for(j = 0; j < i; ++j)
+                close(l->fd[j]);
+            close(par_fd[0]);
+            fd = par_fd[1];
+            filho.fd = &fd;
+            filho.n = 1;
+            tf.envia = envia_local;
+            tf.recebe = recebe_local;
+            tf.dados = &filho;
+            _exit(trabalhador_emparelhamento(&tf) ? 0 : 1);
+        }
+        close(par_fd[1]);
+        l->fd[i] = par_fd[0];
+        l->n = i + 1;
+    }
+    if(l->n < n_partes) {
+        fecha_transporte_local(t);
+        return 0;
+    }
+    return 1;
+}
+
+void fecha_transporte_local(transporte *t) {
+    struct transporte_local *l = t->dados;
+    unsigned int i;
+
+    for(i = 0; i < l->n; ++i)
+        close(l->fd[i]);
+    for(i = 0; i < l->n; ++i)
+        waitpid(l->pid[i], NULL, 0);
+    LIBERA(l->fd);
+    LIBERA(l->pid);
+    LIBERA(l);
+    t->dados = NULL;
+}
+
+int envia_mensagem(transporte *t, unsigned int parte, unsigned int tipo, const unsigned int *dados, unsigned int n) {
+    unsigned int cab[2];
+
+    cab[0] = tipo;
+    cab[1] = n;
+    return t->envia(t, parte, cab, 2) && (n == 0 || t->envia(t, parte, dados, n));
+}
+
+unsigned int recebe_mensagem(transporte *t, unsigned int parte, unsigned int *tipo, unsigned int **dados, unsigned int *cap) {
+    unsigned int cab[2], *novo;
+
+    if(!t->recebe(t, parte, cab, 2))
+        return NENHUM;
+    if(cab[1] + 1 > *cap) {
+        if(!(novo = REALOCA(MEM_ES, *dados, (cab[1] + 1) * sizeof(unsigned int))))
+            return NENHUM;
+        *dados = novo;
+        *cap = cab[1] + 1;
+    }
+    if(cab[1] > 0 && !t->recebe(t, parte, *dados, cab[1]))
+        return NENHUM;
+    *tipo = cab[0];
+    return cab[1];
+}
+
+int trabalhador_emparelhamento(transporte *t) {
+    /* Guarda as arestas recebidas (l, r), com l do lado 0 e desta parte. No
+     * fim delas, monta a adjacencia compactada e devolve um emparelhamento
+     * maximo das arestas internas (com r tambem desta parte); depois, pra
+     * cada camada, devolve todos os arcos dos vertices pedidos, em mensagens
+     * MSG_VIZINHOS de LOTE_DISTRIBUIDO arcos e uma MSG_FIM_VIZINHOS com o
+     * resto (talvez nenhum), pra que nenhum dos lados guarde a camada
+     * inteira. */
+    unsigned int *msg = NULL, *resp = NULL, *arestas = NULL, *novo, *ini = NULL, *adj = NULL;
+    unsigned int cap = 0, cap_resp = 0, cap_arestas = 0, n_arestas_p = 0, tipo, k, i, j, x;
+    unsigned int n = 0, parte = 0, n_partes = 1;
+    struct componentes c;
+    int ok = 0;
+
+    memset(&c, 0, sizeof(struct componentes));
+    for(;;) {
+        if((k = recebe_mensagem(t, 0, &tipo, &msg, &cap)) == NENHUM)
+            goto fim;
+        if(tipo == MSG_SAIR) {
+            ok = 1;
+            goto fim;
+        } else if(tipo == MSG_INICIO && k == 3) {
+            n = msg[0];
+            parte = msg[1];
+            n_partes = msg[2];
+        } else if(tipo == MSG_ARESTAS) {
+            if(n_arestas_p + k > cap_arestas) {
+                cap_arestas = 2 * (n_arestas_p + k);
+                if(!(novo = REALOCA(MEM_ES, arestas, cap_arestas * sizeof(unsigned int))))
+                    goto fim;
+                arestas = novo;
+            }
+            memcpy(arestas + n_arestas_p, msg, k * sizeof(unsigned int));
+            n_arestas_p += k;
+        } else if(tipo == MSG_FIM_ARESTAS) {
+            // Adjacencia de todas as arestas, e outra so das internas.
+            if(!(ini = ALOCA_ZERADO(MEM_ES, n + 2, sizeof(unsigned int))) || !(adj = ALOCA(MEM_ES, (n_arestas_p / 2 + 1) * sizeof(unsigned int)))
+               || !(c.ini = ALOCA_ZERADO(MEM_ES, n + 2, sizeof(unsigned int))) || !(c.adj = ALOCA(MEM_ES, (n_arestas_p / 2 + 1) * sizeof(unsigned int)))
+               || !(c.lado = ALOCA(MEM_ES, n + 1)) || !(c.par = ALOCA(MEM_ES, (n + 1) * sizeof(unsigned int)))
+               || !(c.visita = ALOCA_ZERADO(MEM_ES, n + 1, sizeof(unsigned int))) || !(c.iter = ALOCA(MEM_ES, (n + 1) * sizeof(unsigned int)))
+               || !(c.pilha = ALOCA(MEM_ES, (n + 1) * sizeof(unsigned int))) || !(c.nivel = ALOCA(MEM_ES, (n + 1) * sizeof(unsigned int))))
+                goto fim;
+            c.n = n;
+            for(x = 0; x < n; ++x) {
+                c.par[x] = NENHUM;
+                c.lado[x] = 1;
+            }
+            for(i = 0; i < n_arestas_p; i += 2) {
+                ++ini[arestas[i] + 2];
+                c.lado[arestas[i]] = 0;
+                if(arestas[i+1] % n_partes == parte)
+                    ++c.ini[arestas[i] + 2];
+            }
+            for(x = 0; x < n; ++x) {
+                ini[x+2] += ini[x+1];
+                c.ini[x+2] += c.ini[x+1];
+            }
+            for(i = 0; i < n_arestas_p; i += 2) {
+                adj[ini[arestas[i] + 1]++] = arestas[i+1];
+                if(arestas[i+1] % n_partes == parte)
+                    c.adj[c.ini[arestas[i] + 1]++] = arestas[i+1];
+            }
+            LIBERA(arestas);
+            arestas = NULL;
+            hopcroft_karp(&c, 0);
+            for(j = 0, x = 0; x < n; ++x)
+                if(c.lado[x] == 0 && c.par[x] != NENHUM)
+                    j += 2;
+            if(j + 1 > cap_resp) {
+                if(!(novo = REALOCA(MEM_ES, resp, (j + 1) * sizeof(unsigned int))))
+                    goto fim;
+                resp = novo;
+                cap_resp = j + 1;
+            }
+            for(j = 0, x = 0; x < n; ++x) {
+                if(c.lado[x] == 0 && c.par[x] != NENHUM) {
+                    resp[j++] = x;
+                    resp[j++] = c.par[x];
+                }
+            }
+            libera_componentes(&c);
+            memset(&c, 0, sizeof(struct componentes));
+            if(!envia_mensagem(t, 0, MSG_PARES, resp, j))
+                goto fim;
+        } else if(tipo == MSG_CAMADA && ini) {
+            if(2 * LOTE_DISTRIBUIDO > cap_resp) {
+                if(!(novo = REALOCA(MEM_ES, resp, 2 * LOTE_DISTRIBUIDO * sizeof(unsigned int))))
+                    goto fim;
+                resp = novo;
+                cap_resp = 2 * LOTE_DISTRIBUIDO;
+            }
+            for(j = 0, i = 0; i < k; ++i) {
+                for(x = ini[msg[i]]; x < ini[msg[i] + 1]; ++x) {
+                    resp[j++] = msg[i];
+                    resp[j++] = adj[x];
+                    if(j == 2 * LOTE_DISTRIBUIDO) {
+                        if(!envia_mensagem(t, 0, MSG_VIZINHOS, resp, j))
+                            goto fim;
+                        j = 0;
+                    }
+                }
+            }
+            if(!envia_mensagem(t, 0, MSG_FIM_VIZINHOS, resp, j))
+                goto fim;
+        } else {
+            goto fim; // Mensagem fora do protocolo.
+        }
+    }
+
+fim:
+    libera_componentes(&c);
+    LIBERA(msg); LIBERA(resp); LIBERA(arestas); LIBERA(ini); LIBERA(adj);
+    return ok;
+}
+
+grafo emparelhamento_distribuido(FILE *arestas, unsigned int n_partes, transporte *t) {
+    /* O coordenador le as arestas duas vezes: na primeira, numera os
+     * vertices e calcula os lados; na segunda, manda cada aresta pra parte do
+     * seu vertice do lado 0. Os emparelhamentos maximos internos das partes
+     * sao disjuntos e formam o emparelhamento inicial. Depois, cada fase eh
+     * a de emparelhamento_em_passadas(), com cada camada da busca em largura
+     * pedida as partes (que devolvem os arcos dos vertices da camada), ate
+     * nao haver caminho aumentante. */
+    if(arestas == NULL || n_partes == 0)
+        return NULL;
+
+    struct passadas p;
+    transporte local;
+    char nu[TAM_NOME], nv[TAM_NOME];
+    unsigned int *lote = NULL, *usados = NULL, *msg = NULL, cab[3], cap = 0, tipo, k;
+    unsigned int i, j, x, u, v, d, n_fins, novos, fase = 0;
+    int bip, iniciado = 0;
+    grafo emp = NULL;
+
+    if(!inicia_passadas(&p))
+        goto erro_memoria;
+    if(fseek(arestas, 0, SEEK_SET) != 0) {
+        perror("(emparelhamento_distribuido) O arquivo de arestas precisa permitir varias leituras.");
+        goto fim;
+    }
+    if((bip = le_lados_passadas(&p, arestas, 0)) < 0)
+        goto erro_memoria;
+    if(!bip)
+        goto fim;
+    if(!prepara_camadas_passadas(&p) || !(lote = ALOCA(MEM_ES, (size_t) n_partes * 2 * LOTE_DISTRIBUIDO * sizeof(unsigned int)))
+       || !(usados = ALOCA_ZERADO(MEM_ES, n_partes, sizeof(unsigned int))))
+        goto erro_memoria;
+    if(t == NULL) {
+        if(!cria_transporte_local(&local, n_partes)) {
+            perror("(emparelhamento_distribuido) Erro ao criar as partes.");
+            goto fim;
+        }
+        t = &local;
+    }
+    iniciado = 1;
+
+    // Distribui as arestas, em lotes por parte.
+    for(i = 0; i < n_partes; ++i) {
+        cab[0] = p.n;
+        cab[1] = i;
+        cab[2] = n_partes;
+        if(!envia_mensagem(t, i, MSG_INICIO, cab, 3))
+            goto erro_comunicacao;
+    }
+    rewind(arestas);
+    while(le_aresta_passadas(arestas, nu, nv)) {
+        u = id_passadas(&p, nu, 0);
+        v = id_passadas(&p, nv, 0);
+        if(u == v)
+            continue;
+        if(p.paridade[u]) {
+            x = u;
+            u = v;
+            v = x;
+        }
+        i = u % n_partes;
+        lote[2 * LOTE_DISTRIBUIDO * i + usados[i]++] = u;
+        lote[2 * LOTE_DISTRIBUIDO * i + usados[i]++] = v;
+        if(usados[i] == 2 * LOTE_DISTRIBUIDO) {
+            if(!envia_mensagem(t, i, MSG_ARESTAS, lote + 2 * LOTE_DISTRIBUIDO * i, usados[i]))
+                goto erro_comunicacao;
+            usados[i] = 0;
+        }
+    }
+    for(i = 0; i < n_partes; ++i)
+        if((usados[i] && !envia_mensagem(t, i, MSG_ARESTAS, lote + 2 * LOTE_DISTRIBUIDO * i, usados[i]))
+           || !envia_mensagem(t, i, MSG_FIM_ARESTAS, NULL, 0))
+            goto erro_comunicacao;
+    for(i = 0; i < n_partes; ++i) {
+        if((k = recebe_mensagem(t, i, &tipo, &msg, &cap)) == NENHUM || tipo != MSG_PARES)
+            goto erro_comunicacao;
+        for(j = 0; j + 1 < k; j += 2) {
+            p.par[msg[j]] = msg[j+1];
+            p.par[msg[j+1]] = msg[j];
+        }
+    }
+
+    // Caminhos aumentantes entre as partes.
+    for(;;) {
+        inicia_fase_passadas(&p);
+        for(d = 0, n_fins = 0; ; ++d) {
+            // P.fins serve de rascunho pros pedidos (n_fins ainda eh 0).
+            for(i = 0; i < n_partes; ++i) {
+                for(usados[i] = 0, x = i; x < p.n; x += n_partes)
+                    if(p.nivel[x] == d && p.paridade[x] == 0)
+                        p.fins[usados[i]++] = x;
+                if(!envia_mensagem(t, i, MSG_CAMADA, p.fins, usados[i]))
+                    goto erro_comunicacao;
+            }
+            for(novos = 0, i = 0; i < n_partes; ++i) {
+                do {
+                    if((k = recebe_mensagem(t, i, &tipo, &msg, &cap)) == NENHUM
+                       || (tipo != MSG_VIZINHOS && tipo != MSG_FIM_VIZINHOS))
+                        goto erro_comunicacao;
+                    for(j = 0; j + 1 < k; j += 2)
+                        expande_passadas(&p, msg[j], msg[j+1], d, &n_fins, &novos);
+                } while(tipo == MSG_VIZINHOS);
+            }
+            if(n_fins || !novos)
+                break;
+        }
+        if(n_fins == 0)
+            break; // Nao ha caminho aumentante: maximo.
+        CONTA(fases_camadas, 1);
+        aumenta_passadas(&p, n_fins, ++fase);
+    }
+
+    for(i = 0; i < n_partes; ++i)
+        if(!envia_mensagem(t, i, MSG_SAIR, NULL, 0))
+            goto erro_comunicacao;
+    if(!(emp = grafo_pares(p.n, p.par, (const char *) p.nome)))
+        goto erro_memoria;
+    goto fim;
+
+erro_comunicacao:
+    perror("(emparelhamento_distribuido) Erro de comunicacao com as partes.");
+    goto fim;
+erro_memoria:
+    perror("(emparelhamento_distribuido) Erro ao allocar memoria.");
+fim:
+    if(iniciado && t == &local)
+        fecha_transporte_local(&local);
+    LIBERA(lote); LIBERA(usados); LIBERA(msg);
+    libera_passadas(&p);
+    return emp;
+}
+
+unsigned long long mistura_hash(unsigned long long x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+unsigned long long hash_nome(const char *nome) {
+    unsigned long long h = 14695981039346656037ULL;
+
+    for(; *nome; ++nome)
+        h = (h ^ (unsigned char) *nome) * 1099511628211ULL;
+    return mistura_hash(h);
+}
+
+unsigned long long hash_grafo(grafo g) {
+    unsigned long long hv = 0, ha = 0, x, y, h;
+    no elem, elem_a;
+    vertice v;
+    aresta a;
+
+    if(g->hash)
+        return g->hash;
+    // Soma de um hash por vertice e de um por aresta: a soma nao depende da
+    // ordem, e cada parcela eh embaralhada pra que somas diferentes nao se
+    // cancelem. Numa aresta nao direcionada os nomes entram em ordem.
+    for(elem = primeiro_no(g->v); elem; elem = proximo_no(elem)) {
+        v = (vertice) conteudo(elem);
+        x = hash_nome(v->nome);
+        hv += x;
+        for(elem_a = primeiro_no(v->saida); elem_a; elem_a = proximo_no(elem_a)) {
+            a = (aresta) conteudo(elem_a);
+            y = hash_nome(a->vc->nome);
+            if(!g->direcao && y < x)
+                h = mistura_hash(y) + x;
+            else
+                h = mistura_hash(x) + y;
+            ha += mistura_hash(h ^ mistura_hash((unsigned long long) a->peso + 0x9e3779b97f4a7c15ULL));
+        }
+    }
+    h = mistura_hash(mistura_hash(hv) + ha + (unsigned long long) g->direcao);
+    // 0 indica hash por calcular.
+    return g->hash = h ? h : 1;
+}
+
+vertice *tabela_nomes(grafo g, unsigned int *tam) {
+    vertice *tabela;
+    unsigned int i;
+    no elem;
+
+    for(*tam = 16; *tam < 2 * tamanho_lista(g->v); *tam *= 2)
+        ;
+    if(!(tabela = ALOCA_ZERADO(MEM_ALGORITMOS, *tam, sizeof(vertice))))
+        return NULL;
+    for(elem = primeiro_no(g->v); elem; elem = proximo_no(elem)) {
+        vertice v = (vertice) conteudo(elem);
+
+        for(i = (unsigned int) hash_nome(v->nome) & (*tam - 1); tabela[i]; i = (i + 1) & (*tam - 1))
+            ;
+        tabela[i] = v;
+    }
+    return tabela;
+}
+
+vertice procura_tabela_nomes(vertice *tabela, unsigned int tam, const char *nome) {
+    unsigned int i;
+
+    for(i = (unsigned int) hash_nome(nome) & (tam - 1); tabela[i]; i = (i + 1) & (tam - 1))
+        if(strcmp(tabela[i]->nome, nome) == 0)
+            return tabela[i];
+    return NULL;
+}
+
+size_t dados_cache(const struct registro_cache *r) {
+    return (size_t) r->n_pares * (sizeof(long int) + 2 * sizeof(unsigned int)) + r->tam_nomes;
+}
+
+struct entrada_cache *nova_entrada_cache(const struct registro_cache *r) {
+    struct entrada_cache *e = ALOCA(MEM_ES, sizeof(struct entrada_cache) + dados_cache(r));
+
+    if(!e)
+        return NULL;
+    e->r = *r;
+    e->pesos = (long int *) (e + 1);
+    e->pares = (unsigned int *) (e->pesos + r->n_pares);
+    e->nomes = (char *) (e->pares + 2 * (size_t) r->n_pares);
+    e->prox = e->mais_nova = e->mais_velha = NULL;
+    e->refs = 0;
+    e->removida = 0;
+    return e;
+}
+
+int valida_entrada_cache(const struct entrada_cache *e) {
+    const char *p = e->nomes, *fim = e->nomes + e->r.tam_nomes, *z;
+    unsigned int i;
+
+    for(i = 0; i < e->r.n_nomes; ++i, p = z + 1) {
+        z = memchr(p, '\0', (size_t) (fim - p) < TAM_NOME ? (size_t) (fim - p) : TAM_NOME);
+        if(z == NULL)
+            return 0;
+    }
+    if(p != fim)
+        return 0;
+    for(i = 0; i < 2 * e->r.n_pares; ++i)
+        if(e->pares[i] >= e->r.n_nomes)
+            return 0;
+    return 1;
+}
+
+size_t tamanho_entrada_cache(const struct entrada_cache *e) {
+    return sizeof(struct entrada_cache) + dados_cache(&e->r);
+}
+
+struct entrada_cache *procura_cache(cache_grafo c, grafo g, unsigned int tipo) {
+    struct entrada_cache *e;
+
+    for(e = c->balde[g->hash & (c->tam - 1)]; e; e = e->prox)
+        if(e->r.hash == g->hash && e->r.tipo == tipo
+           && e->r.n == tamanho_lista(g->v) && e->r.m == g->n_arestas)
+            break;
+    if(e && e != c->nova) {
+        // Passa e pra frente da lista LRU.
+        e->mais_nova->mais_velha = e->mais_velha;
+        if(e->mais_velha)
+            e->mais_velha->mais_nova = e->mais_nova;
+        else
+            c->velha = e->mais_nova;
+        e->mais_nova = NULL;
+        e->mais_velha = c->nova;
+        c->nova->mais_nova = e;
+        c->nova = e;
+    }
+    return e;
+}
+
+void descarta_cache(cache_grafo c, struct entrada_cache *e) {
+    struct entrada_cache **a;
+
+    for(a = &c->balde[e->r.hash & (c->tam - 1)]; *a != e; a = &(*a)->prox)
+        ;
+    *a = e->prox;
+    if(e->mais_nova)
+        e->mais_nova->mais_velha = e->mais_velha;
+    else
+        c->nova = e->mais_velha;
+    if(e->mais_velha)
+        e->mais_velha->mais_nova = e->mais_nova;
+    else
+        c->velha = e->mais_nova;
+    --c->n;
+    c->bytes -= tamanho_entrada_cache(e);
+    if(e->refs == 0)
+        LIBERA(e);
+    else
+        e->removida = 1;
+}
+
+void solta_cache(cache_grafo c, struct entrada_cache *e) {
+    int libera;
+
+    pthread_mutex_lock(&c->trava);
+    libera = --e->refs == 0 && e->removida;
+    pthread_mutex_unlock(&c->trava);
+    if(libera)
+        LIBERA(e);
+}
+
+void guarda_cache(cache_grafo c, struct entrada_cache *e, int grava) {
+    struct entrada_cache *f, **balde, *prox;
+    unsigned int i;
+
+    for(f = c->balde[e->r.hash & (c->tam - 1)]; f; f = f->prox) {
+        if(f->r.hash == e->r.hash && f->r.tipo == e->r.tipo && f->r.n == e->r.n && f->r.m == e->r.m) {
+            LIBERA(e);
+            return;
+        }
+    }
+    // Dobra a tabela quando as listas ficam com mais de 2 entradas em media.
+    if(c->n >= 2 * c->tam && (balde = ALOCA_ZERADO(MEM_ES, 2 * c->tam, sizeof(struct entrada_cache *)))) {
+        for(i = 0; i < c->tam; ++i) {
+            for(f = c->balde[i]; f; f = prox) {
+                prox = f->prox;
+                f->prox = balde[f->r.hash & (2 * c->tam - 1)];
+                balde[f->r.hash & (2 * c->tam - 1)] = f;
+            }
+        }
+        LIBERA(c->balde);
+        c->balde = balde;
+        c->tam *= 2;
+    }
+    e->prox = c->balde[e->r.hash & (c->tam - 1)];
+    c->balde[e->r.hash & (c->tam - 1)] = e;
+    e->mais_velha = c->nova;
+    if(c->nova)
+        c->nova->mais_nova = e;
+    else
+        c->velha = e;
+    c->nova = e;
+    ++c->n;
+    c->bytes += tamanho_entrada_cache(e);
+    // A entrada nova fica mesmo que sozinha passe do limite.
+    while(c->bytes > c->limite && c->velha != e)
+        descarta_cache(c, c->velha);
+    if(grava && c->arquivo) {
+        if(fwrite(&e->r, sizeof(struct registro_cache), 1, c->arquivo) != 1
+           || fwrite(e + 1, 1, dados_cache(&e->r), c->arquivo) != dados_cache(&e->r)
+           || fflush(c->arquivo) != 0)
+            perror("(guarda_cache) Erro ao gravar o arquivo do cache.");
+    }
+}
+
+void guarda_resultado_cache(cache_grafo c, grafo g, unsigned int tipo, unsigned int valor, grafo emp, lista l) {
+    struct registro_cache r;
+    struct entrada_cache *e;
+    unsigned int i, k;
+    no elem, elem_a;
+    vertice v;
+    aresta a;
+    char *nome;
+
+    memset(&r, 0, sizeof(r));
+    r.hash = g->hash;
+    r.n = tamanho_lista(g->v);
+    r.m = g->n_arestas;
+    r.tipo = tipo;
+    r.valor = valor;
+    if(emp)
+        l = emp->v;
+    if(l) {
+        r.n_nomes = tamanho_lista(l);
+        for(elem = primeiro_no(l); elem; elem = proximo_no(elem))
+            r.tam_nomes += (unsigned int) strlen(((vertice) conteudo(elem))->nome) + 1;
+    }
+    if(emp)
+        r.n_pares = emp->n_arestas;
+    if(!(e = nova_entrada_cache(&r))) {
+        perror("(guarda_resultado_cache) Erro ao allocar memoria.");
+        return;
+    }
+    // Os nomes ficam na ordem da lista, e o indice de cada vertice fica em
+    // v->atributo pra numerar as arestas.
+    nome = e->nomes;
+    for(i = 0, elem = l ? primeiro_no(l) : NULL; elem; elem = proximo_no(elem), ++i) {
+        v = (vertice) conteudo(elem);
+        strcpy(nome, v->nome);
+        nome += strlen(nome) + 1;
+        v->atributo = (int) i;
+    }
+    for(k = 0, elem = emp ? primeiro_no(emp->v) : NULL; elem; elem = proximo_no(elem)) {
+        v = (vertice) conteudo(elem);
+        for(elem_a = primeiro_no(v->saida); elem_a; elem_a = proximo_no(elem_a), ++k) {
+            a = (aresta) conteudo(elem_a);
+            e->pares[2 * k] = (unsigned int) a->vs->atributo;
+            e->pares[2 * k + 1] = (unsigned int) a->vc->atributo;
+            e->pesos[k] = a->peso;
+        }
+    }
+    pthread_mutex_lock(&c->trava);
+    guarda_cache(c, e, 1);
+    pthread_mutex_unlock(&c->trava);
+}
+
+char **nomes_cache(struct entrada_cache *e, char **nome) {
+    char *p = e->nomes;
+    unsigned int i;
+
+    for(i = 0; i < e->r.n_nomes; ++i, p += strlen(p) + 1)
+        nome[i] = p;
+    return nome;
+}
+
+cache_grafo constroi_cache_grafo(const char *arquivo, size_t limite) {
+    cache_grafo c = ALOCA_ZERADO(MEM_ES, 1, sizeof(struct cache_grafo));
+    struct registro_cache r;
+    struct entrada_cache *e;
+    char magica[8];
+    long int fim, tam_arquivo;
+
+    if(!c || !(c->balde = ALOCA_ZERADO(MEM_ES, BALDES_CACHE, sizeof(struct entrada_cache *)))) {
+        perror("(constroi_cache_grafo) Erro ao allocar memoria.");
+        LIBERA(c);
+        return NULL;
+    }
+    c->tam = BALDES_CACHE;
+    c->limite = limite ? limite : LIMITE_CACHE;
+    pthread_mutex_init(&c->trava, NULL);
+    if(!arquivo)
+        return c;
+
+    if(!(c->arquivo = fopen(arquivo, "a+b"))) {
+        perror("(constroi_cache_grafo) Erro ao abrir o arquivo do cache.");
+        destroi_cache_grafo(c);
+        return NULL;
+    }
+    rewind(c->arquivo);
+    if(fread(magica, sizeof(magica), 1, c->arquivo) != 1) {
+        // Arquivo novo (ou vazio).
+        if(ftruncate(fileno(c->arquivo), 0) != 0 || fwrite("GRAFOCCH", sizeof(magica), 1, c->arquivo) != 1
+           || fflush(c->arquivo) != 0) {
+            perror("(constroi_cache_grafo) Erro ao gravar o arquivo do cache.");
+            destroi_cache_grafo(c);
+            return NULL;
+        }
+        return c;
+    }
+    if(memcmp(magica, "GRAFOCCH", sizeof(magica)) != 0) {
+        perror("(constroi_cache_grafo) O arquivo nao eh um cache de grafos.");
+        destroi_cache_grafo(c);
+        return NULL;
+    }
+    // Carrega os registros (os mais recentes, que ficam no fim, ocupam o
+    // limite); um registro incompleto ou inconsistente (o processo que
+    // gravava morreu no meio, ou o arquivo estragou) eh cortado fora junto
+    // com o resto, que nao da mais pra separar em registros.
+    fim = ftell(c->arquivo);
+    if(fseek(c->arquivo, 0, SEEK_END) != 0 || (tam_arquivo = ftell(c->arquivo)) < 0
+       || fseek(c->arquivo, fim, SEEK_SET) != 0)
+        tam_arquivo = fim;
+    for(; fread(&r, sizeof(r), 1, c->arquivo) == 1; fim = ftell(c->arquivo)) {
+        if(dados_cache(&r) > (size_t) (tam_arquivo - fim) - sizeof(r) || !(e = nova_entrada_cache(&r)))
+            break;
+        if(fread(e + 1, 1, dados_cache(&r), c->arquivo) != dados_cache(&r) || !valida_entrada_cache(e)) {
+            LIBERA(e);
+            break;
+        }
+        guarda_cache(c, e, 0);
+    }
+    if(fseek(c->arquivo, 0, SEEK_END) == 0 && ftell(c->arquivo) != fim)
+        if(ftruncate(fileno(c->arquivo), (off_t) fim) != 0)
+            perror("(constroi_cache_grafo) Erro ao cortar o arquivo do cache.");
+    return c;
+}
+
+int destroi_cache_grafo(cache_grafo c) {
+    struct entrada_cache *e, *prox;
+    unsigned int i;
+    int ok = 1;
+
+    if(c == NULL)
+        return 1;
+    for(i = 0; i < c->tam; ++i) {
+        for(e = c->balde[i]; e; e = prox) {
+            prox = e->prox;
+            LIBERA(e);
+        }
+    }
+    if(c->arquivo && fclose(c->arquivo) != 0)
+        ok = 0;
+    pthread_mutex_destroy(&c->trava);
+    LIBERA(c->balde);
+    LIBERA(c);
+    return ok;
+}
+
+grafo emparelhamento_maximo_cache(cache_grafo c, grafo g) {
+    struct entrada_cache *e;
+    char **nome;
+    vertice *copia;
+    unsigned int i, k;
+    grafo emp;
+
+    hash_grafo(g);
+    pthread_mutex_lock(&c->trava);
+    if((e = procura_cache(c, g, CACHE_EMPARELHAMENTO))) {
+        ++c->acertos;
+        ++e->refs; // e eh lida sem a trava, e nao pode ser liberada antes.
+    } else
+        ++c->faltas;
+    pthread_mutex_unlock(&c->trava);
+
+    if(e) {
+        if(!e->r.valor) {
+            solta_cache(c, e);
+            return NULL;
+        }
+        nome = ALOCA(MEM_ES, e->r.n_nomes * sizeof(char *) + 1);
+        copia = ALOCA(MEM_ES, e->r.n_nomes * sizeof(vertice) + 1);
+        if(!nome || !copia || !(emp = constroi_grafo())) {
+            perror("(emparelhamento_maximo_cache) Erro ao allocar memoria.");
+            LIBERA(nome);
+            LIBERA(copia);
+            solta_cache(c, e);
+            return NULL;
+        }
+        strcpy(emp->nome, "Max Matching");
+        // insere_lista insere no comeco, entao vertices e arestas sao
+        // inseridos de tras pra frente pra ficarem na ordem guardada.
+        nomes_cache(e, nome);
+        for(i = e->r.n_nomes; i-- > 0; )
+            copia[i] = insere_vertice(emp, nome[i]);
+        for(k = e->r.n_pares; k-- > 0; )
+            insere_aresta(emp, copia[e->pares[2 * k]], copia[e->pares[2 * k + 1]], e->pesos[k]);
+        LIBERA(nome);
+        LIBERA(copia);
+        solta_cache(c, e);
+        return emp;
+    }
+
+    if(!bipartido(g, NULL)) {
+        guarda_resultado_cache(c, g, CACHE_EMPARELHAMENTO, 0, NULL, NULL);
+        return NULL;
+    }
+    emparelha(g);
+    emp = grafo_emparelhamento(g);
+    guarda_resultado_cache(c, g, CACHE_EMPARELHAMENTO, 1, emp, NULL);
+    return emp;
+}
+
+lista busca_largura_lexicografica_cache(cache_grafo c, grafo g) {
+    struct entrada_cache *e;
+    char **nome = NULL;
+    vertice *tabela = NULL, v;
+    unsigned int i, tam;
+    lista l = NULL;
+
+    hash_grafo(g);
+    pthread_mutex_lock(&c->trava);
+    if((e = procura_cache(c, g, CACHE_LEXICOGRAFICA))) {
+        ++c->acertos;
+        ++e->refs;
+    } else
+        ++c->faltas;
+    pthread_mutex_unlock(&c->trava);
+
+    if(e && (nome = ALOCA(MEM_ES, e->r.n_nomes * sizeof(char *) + 1)) && (tabela = tabela_nomes(g, &tam))) {
+        l = constroi_lista();
+        nomes_cache(e, nome);
+        for(i = e->r.n_nomes; i-- > 0; ) {
+            // Um nome que nao esta em g so acontece numa colisao do hash:
+            // nesse caso a busca eh feita de novo.
+            if(!(v = procura_tabela_nomes(tabela, tam, nome[i]))) {
+                destroi_lista(l, NULL);
+                l = NULL;
+                break;
+            }
+            insere_lista(v, l);
+        }
+        LIBERA(tabela);
+    }
+    LIBERA(nome);
+    if(e) {
+        solta_cache(c, e);
+        if(l)
+            return l;
+    }
+
+    l = busca_largura_lexicografica(g);
+    guarda_resultado_cache(c, g, CACHE_LEXICOGRAFICA, 0, NULL, l);
+    return l;
+}
+
+int cordal_cache(cache_grafo c, grafo g) {
+    struct entrada_cache *e;
+    lista l;
+    int ret;
+
+    if(g->direcao) // Grafos direcionados nao sao cordais
+        return 0;
+
+    hash_grafo(g);
+    pthread_mutex_lock(&c->trava);
+    if((e = procura_cache(c, g, CACHE_CORDAL))) {
+        ++c->acertos;
+        ret = (int) e->r.valor;
+    } else
+        ++c->faltas;
+    pthread_mutex_unlock(&c->trava);
+    if(e)
+        return ret;
+
+    l = busca_largura_lexicografica_cache(c, g);
+    ret = ordem_perfeita_eliminacao(l, g);
+    destroi_lista(l, NULL);
+    guarda_resultado_cache(c, g, CACHE_CORDAL, (unsigned int) ret, NULL, NULL);
+    return ret;
+}
+
+void estatisticas_cache(cache_grafo c, unsigned int *acertos, unsigned int *faltas) {
+    pthread_mutex_lock(&c->trava);
+    *acertos = c->acertos;
+    *faltas = c->faltas;
+    pthread_mutex_unlock(&c->trava);
+}
+
+unsigned int *pares_emparelhamento(grafo g, grafo emparelhamento) {
+    unsigned int *par = malloc(tamanho_lista(g->v) * sizeof(unsigned int) + 1), i, tam;
+    vertice *tabela = tabela_nomes(g, &tam), u, v;
+    no elem, elem_a;
+    aresta a;
+
+    if(!par || !tabela) {
+        perror("(pares_emparelhamento) Erro ao allocar memoria.");
+        free(par);
+        LIBERA(tabela);
+        return NULL;
+    }
+    for(i = 0, elem = primeiro_no(g->v); elem; elem = proximo_no(elem), ++i) {
+        ((vertice) conteudo(elem))->atributo = (int) i;
+        par[i] = NENHUM;
+    }
+    for(elem = primeiro_no(emparelhamento->v); elem; elem = proximo_no(elem)) {
+        for(elem_a = primeiro_no(((vertice) conteudo(elem))->saida); elem_a; elem_a = proximo_no(elem_a)) {
+            a = (aresta) conteudo(elem_a);
+            u = procura_tabela_nomes(tabela, tam, a->vs->nome);
+            v = procura_tabela_nomes(tabela, tam, a->vc->nome);
+            if(!u || !v)
+                continue;
+            par[u->atributo] = (unsigned int) v->atributo;
+            par[v->atributo] = (unsigned int) u->atributo;
+        }
+    }
+    LIBERA(tabela);
+    return par;
+}
+
+unsigned int *le_pares_emparelhamento(FILE *f, grafo g) {
+    unsigned int n, *par;
+
+    if(fread(&n, sizeof(n), 1, f) != 1 || n != tamanho_lista(g->v)) {
+        perror("(le_pares_emparelhamento) O numero de vertices nao eh o do grafo.");
+        return NULL;
+    }
+    if((par = malloc(n * sizeof(unsigned int) + 1)) == NULL) {
+        perror("(le_pares_emparelhamento) Erro ao allocar memoria.");
+        return NULL;
+    }
+    if(fread(par, sizeof(unsigned int), n, f) != n) {
+        perror("(le_pares_emparelhamento) Erro ao ler os pares.");
+        free(par);
+        return NULL;
+    }
+    return par;
+}
+
+int grava_pares(const char *arquivo, struct componentes *c) {
+    size_t tam = strlen(arquivo);
+    char *tmp = ALOCA(MEM_ES, tam + sizeof(".tmp"));
+    FILE *f = NULL;
+    int ok;
+
+    if(tmp == NULL) {
+        perror("(grava_pares) Erro ao allocar memoria.");
+        return 0;
+    }
+    memcpy(tmp, arquivo, tam);
+    memcpy(tmp + tam, ".tmp", sizeof(".tmp"));
+    ok = (f = fopen(tmp, "wb")) != NULL
+        && fwrite(&c->n, sizeof(c->n), 1, f) == 1
+        && fwrite(c->par, sizeof(unsigned int), c->n, f) == c->n
+        && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    if(f && fclose(f) != 0)
+        ok = 0;
+    // So troca o ponto de controle anterior depois que o novo esta inteiro
+    // no disco.
+    if(!ok || rename(tmp, arquivo) != 0) {
+        perror("(grava_pares) Erro ao gravar o ponto de controle.");
+        if(f)
+            remove(tmp);
+        ok = 0;
+    }
+    LIBERA(tmp);
+    return ok;
+}
+
+grafo continua_emparelhamento(grafo g, const unsigned int *par, const char *ponto_controle,
+                              double intervalo, unsigned int *invalidos) {
+    /* Fases de Hopcroft-Karp como em emparelhamento_com_prazo, mas comecando
+     * dos pares validos de par, completados gulosamente. Os caminhos
+     * aumentantes a partir de um emparelhamento qualquer levam a um maximo
+     * do mesmo jeito; um par quase maximo so deixa poucas fases. */
+    if(g == NULL)
+        return NULL;
+    if(!bipartido(g, NULL))
+        return NULL;
+
+    unsigned int x, y, k, marca = 1, descartados = 0;
+    int valido;
+    double proximo = agora() + intervalo;
+    struct componentes c;
+    grafo emp;
+
+    if(!monta_componentes(g, &c) || !(c.nivel = ALOCA(MEM_ALGORITMOS, (c.n + 1) * sizeof(unsigned int)))) {
+        perror("(continua_emparelhamento) Erro ao allocar memoria.");
+        libera_componentes(&c);
+        return NULL;
+    }
+    for(x = 0; par && x < c.n; ++x) {
+        if((y = par[x]) == NENHUM)
+            continue;
+        valido = 0;
+        if(y < c.n && par[y] == x && c.lado[x] != c.lado[y])
+            for(k = c.ini[x]; k < c.ini[x+1] && !valido; ++k)
+                valido = c.adj[k] == y;
+        if(valido)
+            c.par[x] = y;
+        else
+            ++descartados;
+    }
+    guloso_componentes(&c);
+    while(camadas_componentes(&c, 0, NULL) != NENHUM) {
+        CONTA(fases_camadas, 1);
+        for(x = 0; x < c.n; ++x) {
+            if(c.nivel[x] != 0 || c.par[x] != NENHUM)
+                continue;
+            if(ponto_controle && intervalo > 0 && agora() >= proximo) {
+                grava_pares(ponto_controle, &c);
+                proximo = agora() + intervalo;
+            }
+            aumenta_componente(&c, x, marca, c.pilha, 0);
+        }
+        ++marca;
+    }
+    if(ponto_controle)
+        grava_pares(ponto_controle, &c);
+    if(invalidos)
+        *invalidos = descartados;
+    emp = grava_componentes(g, &c);
+    libera_componentes(&c);
+    return emp;
+}
+
+int liga_contadores(contadores *c) {
+#ifdef CONTADORES
+    contadores_ativos = c;
+    return 1;
+#else
+    (void) c;
+    return 0;
+#endif
+}
+
+void soma_contadores(contadores *c, const contadores *d) {
+    static pthread_mutex_t trava = PTHREAD_MUTEX_INITIALIZER;
+    unsigned int i;
+
+    pthread_mutex_lock(&trava);
+    c->buscas += d->buscas;
+    c->aumentos += d->aumentos;
+    c->arestas_examinadas += d->arestas_examinadas;
+    c->marcas += d->marcas;
+    c->reinicios += d->reinicios;
+    c->fases_camadas += d->fases_camadas;
+    c->comparacoes_rotulo += d->comparacoes_rotulo;
+    c->vertices_lidos += d->vertices_lidos;
+    c->arestas_lidas += d->arestas_lidas;
+    c->vertices_escritos += d->vertices_escritos;
+    c->arestas_escritas += d->arestas_escritas;
+    for(i = 0; i < N_FASES; ++i) {
+        c->chamadas[i] += d->chamadas[i];
+        c->tempo[i] += d->tempo[i];
+    }
+    pthread_mutex_unlock(&trava);
+}
+
+int escreve_contadores(FILE *f, const contadores *c) {
+    const char *fase[N_FASES] = { "leitura", "escrita", "bipartido", "busca", "copia", "lexicografica", "ope" };
+    unsigned int i;
+
+    fprintf(f, "{\"buscas\": %lu, \"aumentos\": %lu, \"arestas_examinadas\": %lu, "
+            "\"marcas\": %lu, \"reinicios\": %lu, \"fases_camadas\": %lu, \"comparacoes_rotulo\": %lu, "
+            "\"vertices_lidos\": %lu, \"arestas_lidas\": %lu, \"vertices_escritos\": %lu, "
+            "\"arestas_escritas\": %lu, \"fases\": {",
+            c->buscas, c->aumentos, c->arestas_examinadas, c->marcas, c->reinicios, c->fases_camadas,
+            c->comparacoes_rotulo, c->vertices_lidos, c->arestas_lidas, c->vertices_escritos,
+            c->arestas_escritas);
+    for(i = 0; i < N_FASES; ++i)
+        fprintf(f, "%s\"%s\": {\"chamadas\": %lu, \"segundos\": %.9f}", i ? ", " : "",
+                fase[i], c->chamadas[i], c->tempo[i]);
+    return fprintf(f, "}}") > 0 && !ferror(f);
+}
+
+#ifdef MEMORIA
+void conta_memoria(unsigned int tag, size_t alocado, size_t liberado) {
+    unsigned int t[2] = { tag, MEM_TOTAL }, i;
+    unsigned long vivos, pico;
+
+    for(i = 0; i < 2; ++i) {
+        // a diferenca "negativa" da a volta certa em aritmetica sem sinal
+        vivos = __sync_add_and_fetch(&memoria_usada[t[i]].vivos, alocado - liberado);
+        while((pico = memoria_usada[t[i]].pico) < vivos
+              && !__sync_bool_compare_and_swap(&memoria_usada[t[i]].pico, pico, vivos))
+            ;
+    }
+}
+
+void *aloca_memoria(unsigned int tag, size_t n) {
+    struct cabecalho_memoria *c = malloc(sizeof(struct cabecalho_memoria) + n);
+
+    if(c == NULL)
+        return NULL;
+    c->tamanho = n;
+    c->tag = tag;
+    __sync_fetch_and_add(&memoria_usada[tag].alocacoes, 1);
+    __sync_fetch_and_add(&memoria_usada[MEM_TOTAL].alocacoes, 1);
+    conta_memoria(tag, n, 0);
+    return c + 1;
+}
+
+void *aloca_zerada_memoria(unsigned int tag, size_t k, size_t n) {
+    struct cabecalho_memoria *c;
+
+    if(n && k > ((size_t) -1 - sizeof(struct cabecalho_memoria)) / n)
+        return NULL;
+    if((c = calloc(1, sizeof(struct cabecalho_memoria) + k * n)) == NULL)
+        return NULL;
+    c->tamanho = k * n;
+    c->tag = tag;
+    __sync_fetch_and_add(&memoria_usada[tag].alocacoes, 1);
+    __sync_fetch_and_add(&memoria_usada[MEM_TOTAL].alocacoes, 1);
+    conta_memoria(tag, k * n, 0);
+    return c + 1;
+}
+
+void *realoca_memoria(unsigned int tag, void *p, size_t n) {
+    struct cabecalho_memoria *c;
+    size_t antes;
+
+    if(p == NULL)
+        return aloca_memoria(tag, n);
+    // o bloco continua na parte em que foi alocado
+    c = (struct cabecalho_memoria *) p - 1;
+    antes = c->tamanho;
+    if((c = realloc(c, sizeof(struct cabecalho_memoria) + n)) == NULL)
+        return NULL;
+    c->tamanho = n;
+    conta_memoria(c->tag, n, antes);
+    return c + 1;
+}
+
+void libera_memoria(void *p) {
+    struct cabecalho_memoria *c;
+
+    if(p == NULL)
+        return;
+    c = (struct cabecalho_memoria *) p - 1;
+    __sync_fetch_and_add(&memoria_usada[c->tag].liberacoes, 1);
+    __sync_fetch_and_add(&memoria_usada[MEM_TOTAL].liberacoes, 1);
+    conta_memoria(c->tag, 0, c->tamanho);
+    free(c);
+}
+#endif
+
+int consulta_memoria(uso_memoria u[N_MEMORIAS]) {
+#ifdef MEMORIA
+    unsigned int i;
+
+    for(i = 0; i < N_MEMORIAS; ++i) {
+        u[i].vivos = __sync_fetch_and_add(&memoria_usada[i].vivos, 0);
+        u[i].pico = __sync_fetch_and_add(&memoria_usada[i].pico, 0);
+        u[i].alocacoes = __sync_fetch_and_add(&memoria_usada[i].alocacoes, 0);
+        u[i].liberacoes = __sync_fetch_and_add(&memoria_usada[i].liberacoes, 0);
+    }
+    return 1;
+#else
+    memset(u, 0, N_MEMORIAS * sizeof(uso_memoria));
+    return 0;
+#endif
+}
+
+void reinicia_pico_memoria(void) {
+#ifdef MEMORIA
+    unsigned int i;
+
+    // um pico acima dos vivos, de outra thread, pode se perder aqui
+    for(i = 0; i < N_MEMORIAS; ++i)
+        __sync_lock_test_and_set(&memoria_usada[i].pico, memoria_usada[i].vivos);
+#endif
+}
+
+int escreve_memoria(FILE *f) {
+    const char *parte[N_MEMORIAS] = { "grafo", "listas", "algoritmos", "es", "total" };
+    uso_memoria u[N_MEMORIAS];
+    unsigned int i;
+
+    consulta_memoria(u);
+    fprintf(f, "{");
+    for(i = 0; i < N_MEMORIAS; ++i)
+        fprintf(f, "%s\"%s\": {\"vivos\": %lu, \"pico\": %lu, \"alocacoes\": %lu, \"liberacoes\": %lu}",
+                i ? ", " : "", parte[i], u[i].vivos, u[i].pico, u[i].alocacoes, u[i].liberacoes);
+    return fprintf(f, "}") > 0 && !ferror(f);
+}
+
+double agora(void) {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+grafo emparelhamento_com_prazo(grafo g, double prazo, volatile int *cancelar, unsigned int *limite_superior) {
+    /* Fases de Hopcroft-Karp, conferindo o prazo e o cancelamento antes de
+     * cada aumento. No fim, uma busca em largura completa a partir dos
+     * vertices livres do lado 0 alcanca um conjunto Z; (lado 0 - Z) mais
+     * (lado 1 em Z) cobre todas as arestas e tem |M| + (livres do lado 1 em
+     * Z) vertices (Konig), limitando o maximo. Se o menor caminho aumentante
+     * tem L arestas de M, tambem vale |M*| <= |M| (L + 1) / L. */
+    if(g == NULL)
+        return NULL;
+    if(!bipartido(g, NULL))
+        return NULL;
+
+    unsigned int x, l, marca = 1, tamanho = 0, livres, lado0 = 0, cota;
+    double fim = agora() + prazo;
+    int parou = 0;
+    struct componentes c;
+    grafo emp = NULL;
+
+    if(!monta_componentes(g, &c) || !(c.nivel = ALOCA(MEM_ALGORITMOS, (c.n + 1) * sizeof(unsigned int)))) {
+        perror("(emparelhamento_com_prazo) Erro ao allocar memoria.");
+        libera_componentes(&c);
+        return NULL;
+    }
+    guloso_componentes(&c);
+    while(!parou && camadas_componentes(&c, 0, NULL) != NENHUM) {
+        CONTA(fases_camadas, 1);
+        for(x = 0; x < c.n && !parou; ++x) {
+            if(c.nivel[x] != 0 || c.par[x] != NENHUM)
+                continue;
+            if((prazo > 0 && agora() >= fim) || (cancelar && *cancelar))
+                parou = 1;
+            else
+                aumenta_componente(&c, x, marca, c.pilha, 0);
+        }
+        ++marca;
+    }
+    if(limite_superior) {
+        for(x = 0; x < c.n; ++x) {
+            if(c.lado[x] == 0) {
+                ++lado0;
+                tamanho += c.par[x] != NENHUM;
+            }
+        }
+        l = camadas_componentes(&c, marca, &livres);
+        *limite_superior = tamanho + livres;
+        if(lado0 < *limite_superior)
+            *limite_superior = lado0;
+        if(c.n - lado0 < *limite_superior)
+            *limite_superior = c.n - lado0;
+        if(l != NENHUM && l > 0 && (cota = tamanho + tamanho / l) < *limite_superior)
+            *limite_superior = cota;
+    }
+    emp = grava_componentes(g, &c);
+    libera_componentes(&c);
+    return emp;
+}
+
+unsigned int nova_fase_murty(struct murty *m) {
+    m->fase += 2;
+    if(m->fase < 2) {
+        memset(m->marca, 0, m->n_nos * sizeof(unsigned int));
+        m->fase = 2;
+    }
+    m->h.n = 0;
+    m->n_feitos = 0;
+    return m->fase;
+}
+
+void relaxa_murty(struct murty *m, unsigned int y, long int d, unsigned int p) {
+    if(m->marca[y] == m->fase + 1)
+        return;
+    if(m->marca[y] != m->fase || d < m->dist[y]) {
+        m->marca[y] = m->fase;
+        m->dist[y] = d;
+        m->pred[y] = p;
+        insere_heap(&m->h, d, y);
+    }
+}
+
+int aumenta_murty(struct murty *m, unsigned int r) {
+    unsigned int t = m->n_nos - 1, x, k, c, antigo, i;
+    long int d;
+    struct item_heap it;
+
+    CONTA(buscas, 1);
+    nova_fase_murty(m);
+    relaxa_murty(m, r, 0, NENHUM);
+    while(m->h.n) {
+        it = remove_heap(&m->h);
+        x = it.x;
+        if(m->marca[x] != m->fase || it.d != m->dist[x])
+            continue;
+        m->marca[x] = m->fase + 1;
+        m->feitos[m->n_feitos++] = x;
+        if(x == t)
+            break;
+        if(x < m->n_lin) {
+            for(k = m->ini[x]; k < m->ini[x+1]; ++k) {
+                c = m->col[k];
+                CONTA(arestas_examinadas, 1);
+                if(k == m->arco_de[x] || m->proib[k] == m->carimbo || m->bloq[c] == m->carimbo)
+                    continue;
+                relaxa_murty(m, m->n_lin + c, it.d + m->custo[k] + m->pot[x] - m->pot[m->n_lin + c], k);
+            }
+        } else if(m->dono[x - m->n_lin] != NENHUM) {
+            relaxa_murty(m, m->dono[x - m->n_lin], it.d, NENHUM);
+        } else {
+            relaxa_murty(m, t, it.d + m->pot[x] - m->pot[t], x - m->n_lin);
+        }
+    }
+    if(m->marca[t] != m->fase + 1)
+        return 0;
+
+    CONTA(aumentos, 1);
+    d = m->dist[t];
+    for(i = 0; i < m->n_feitos; ++i)
+        m->pot[m->feitos[i]] -= d - m->dist[m->feitos[i]];
+    // Inverte o caminho: cada linha passa pra coluna seguinte.
+    for(c = m->pred[t]; ; c = m->col[antigo]) {
+        k = m->pred[m->n_lin + c];
+        x = m->linha[k];
+        antigo = m->arco_de[x];
+        m->arco_de[x] = k;
+        m->dono[c] = x;
+        if(x == r)
+            break;
+    }
+    return 1;
+}
+
+void repara_murty(struct murty *m, unsigned int c) {
+    /* A coluna liberada c eh a unica que pode ter potencial menor que o do
+     * sorvedouro, ou seja, o arco c->T eh o unico com custo reduzido
+     * negativo. Um Dijkstra a partir de T ate c acha o ciclo mais negativo
+     * por ele (se houver) e os novos potenciais. */
+    unsigned int t = m->n_nos - 1, x, k, y, antigo, i;
+    long int limiar = m->pot[t] - m->pot[m->n_lin + c], d;
+    struct item_heap it;
+
+    if(limiar <= 0)
+        return;
+    nova_fase_murty(m);
+    relaxa_murty(m, t, 0, NENHUM);
+    d = limiar;
+    while(m->h.n) {
+        it = remove_heap(&m->h);
+        x = it.x;
+        if(m->marca[x] != m->fase || it.d != m->dist[x])
+            continue;
+        if(it.d >= limiar)
+            break;
+        m->marca[x] = m->fase + 1;
+        m->feitos[m->n_feitos++] = x;
+        if(x == m->n_lin + c) {
+            d = it.d;
+            break;
+        }
+        if(x == t) {
+            for(y = 0; y < m->n_col; ++y)
+                if(m->dono[y] != NENHUM && m->bloq[y] != m->carimbo)
+                    relaxa_murty(m, m->n_lin + y, m->pot[t] - m->pot[m->n_lin + y], NENHUM);
+        } else if(x >= m->n_lin) {
+            relaxa_murty(m, m->dono[x - m->n_lin], it.d, NENHUM);
+        } else {
+            for(k = m->ini[x]; k < m->ini[x+1]; ++k) {
+                y = m->col[k];
+                if(k == m->arco_de[x] || m->proib[k] == m->carimbo || m->bloq[y] == m->carimbo)
+                    continue;
+                if(m->dono[y] != NENHUM || y == c)
+                    relaxa_murty(m, m->n_lin + y, it.d + m->custo[k] + m->pot[x] - m->pot[m->n_lin + y], k);
+            }
+        }
+    }
+    for(i = 0; i < m->n_feitos; ++i)
+        m->pot[m->feitos[i]] -= d - m->dist[m->feitos[i]];
+    if(d == limiar)
+        return; // Nao ha ciclo negativo.
+
+    // Aplica o ciclo: as linhas do caminho T -> ... -> c passam pra coluna
+    // seguinte, e a primeira coluna do caminho fica livre.
+    for(y = c; (k = m->pred[m->n_lin + y]) != NENHUM; y = m->col[antigo]) {
+        x = m->linha[k];
+        antigo = m->arco_de[x];
+        m->arco_de[x] = k;
+        m->dono[y] = x;
+    }
+    m->dono[y] = NENHUM;
+}
+
+int resolve_murty(struct murty *m, struct sub_murty *nos, struct sub_murty *s) {
+    struct sub_murty *pai = &nos[s->pai], *y;
+    unsigned int r, c;
+
+    memcpy(m->arco_de, pai->arco_de, m->n_lin * sizeof(unsigned int));
+    memcpy(m->pot, pai->pot, m->n_nos * sizeof(long int));
+    if(++m->carimbo == 0) {
+        memset(m->proib, 0, m->ini[m->n_lin] * sizeof(unsigned int));
+        memset(m->bloq, 0, m->n_col * sizeof(unsigned int));
+        m->carimbo = 1;
+    }
+    for(c = 0; c < m->n_col; ++c)
+        m->dono[c] = NENHUM;
+    for(r = 0; r < m->n_lin; ++r) {
+        m->dono[m->col[m->arco_de[r]]] = r;
+        if(r < s->f)
+            m->bloq[m->col[m->arco_de[r]]] = m->carimbo;
+    }
+    for(y = s; y->arco != NENHUM && y->f == s->f; y = &nos[y->pai])
+        m->proib[y->arco] = m->carimbo;
+
+    // Libera a linha f e reotimiza.
+    c = m->col[m->arco_de[s->f]];
+    m->arco_de[s->f] = NENHUM;
+    m->dono[c] = NENHUM;
+    repara_murty(m, c);
+    if(!aumenta_murty(m, s->f))
+        return 0;
+
+    s->arco_de = ALOCA(MEM_ALGORITMOS, m->n_lin * sizeof(unsigned int));
+    s->pot = ALOCA(MEM_ALGORITMOS, m->n_nos * sizeof(long int));
+    if(!s->arco_de || !s->pot) {
+        perror("(resolve_murty) Erro ao allocar memoria.");
+        return 0;
+    }
+    memcpy(s->arco_de, m->arco_de, m->n_lin * sizeof(unsigned int));
+    memcpy(s->pot, m->pot, m->n_nos * sizeof(long int));
+    for(s->custo = 0, r = 0; r < m->n_lin; ++r)
+        s->custo += m->custo[m->arco_de[r]];
+    return s->resolvido = 1;
+}
+
+lista emparelhamentos_k_melhores(grafo g, int maximizar, int perfeito, unsigned int k, long int *pesos) {
+    /* Particionamento de Murty com fila de prioridade preguicosa: os filhos
+     * de uma solucao entram na fila com o custo do pai (limite inferior) e so
+     * sao resolvidos quando saem dela. Cada filho eh resolvido a partir da
+     * solucao e dos potenciais (duais) do pai com no maximo dois Dijkstras
+     * (repara_murty e aumenta_murty), em vez de do zero. Com "perfeito", o
+     * arco ficticio custa mais que qualquer combinacao de arestas, entao as
+     * solucoes de tamanho maximo vem primeiro. */
+    if(g == NULL)
+        return NULL;
+
+    unsigned int n = n_vertices(g), i, r, c, q, n_lin = 0, n_nos = 0, cap_nos = 0, ficticios = 0;
+    unsigned int *col_de = NULL;
+    long int grande = 1, minimo = 0, peso;
+    struct murty m;
+    struct sub_murty *nos = NULL, *s, *novo;
+    struct heap fila = { NULL, 0, 0 };
+    struct item_heap it;
+    vertice *vetor, w;
+    cursor_vizinhanca cur;
+    aresta a;
+    grafo e;
+    lista saida = NULL;
+    no prim, x, prox;
+
+    memset(&m, 0, sizeof(struct murty));
+    if(!bipartido(g, NULL))
+        return NULL;
+    vetor = numera_ordem(g->v);
+    col_de = ALOCA(MEM_ALGORITMOS, (n + 1) * sizeof(unsigned int));
+    if(!vetor || !col_de) {
+        perror("(emparelhamentos_k_melhores) Erro ao allocar memoria.");
+        goto fim;
+    }
+    // Linhas: vertices do lado 0; colunas: vertices do lado 1, depois as
+    // ficticias das linhas.
+    for(r = c = i = 0; i < n; ++i)
+        col_de[i] = vetor[i]->lado == 0 ? r++ : c++;
+    n_lin = r;
+    m.n_lin = n_lin;
+    m.n_col = c + n_lin;
+    m.n_nos = n_lin + m.n_col + 1;
+
+    m.ini = ALOCA(MEM_ALGORITMOS, (n_lin + 1) * sizeof(unsigned int));
+    if(m.ini == NULL) {
+        perror("(emparelhamentos_k_melhores) Erro ao allocar memoria.");
+        goto fim;
+    }
+    for(m.ini[0] = 0, r = 0, i = 0; i < n; ++i)
+        if(vetor[i]->lado == 0) {
+            m.ini[r+1] = m.ini[r] + 1 + grau(vetor[i], VIZIN_COMPL, g);
+            ++r;
+        }
+    q = m.ini[n_lin];
+    m.col = ALOCA(MEM_ALGORITMOS, (q + 1) * sizeof(unsigned int));
+    m.linha = ALOCA(MEM_ALGORITMOS, (q + 1) * sizeof(unsigned int));
+    m.proib = ALOCA_ZERADO(MEM_ALGORITMOS, q + 1, sizeof(unsigned int));
+    m.custo = ALOCA(MEM_ALGORITMOS, (q + 1) * sizeof(long int));
+    m.arco = ALOCA(MEM_ALGORITMOS, (q + 1) * sizeof(aresta));
+    m.arco_de = ALOCA(MEM_ALGORITMOS, (n_lin + 1) * sizeof(unsigned int));
+    m.dono = ALOCA(MEM_ALGORITMOS, (m.n_col + 1) * sizeof(unsigned int));
+    m.bloq = ALOCA_ZERADO(MEM_ALGORITMOS, m.n_col + 1, sizeof(unsigned int));
+    m.marca = ALOCA_ZERADO(MEM_ALGORITMOS, m.n_nos, sizeof(unsigned int));
+    m.pred = ALOCA(MEM_ALGORITMOS, m.n_nos * sizeof(unsigned int));
+    m.feitos = ALOCA(MEM_ALGORITMOS, m.n_nos * sizeof(unsigned int));
+    m.pot = ALOCA(MEM_ALGORITMOS, m.n_nos * sizeof(long int));
+    m.dist = ALOCA(MEM_ALGORITMOS, m.n_nos * sizeof(long int));
+    saida = constroi_lista();
+    if(!m.col || !m.linha || !m.proib || !m.custo || !m.arco || !m.arco_de || !m.dono
+       || !m.bloq || !m.marca || !m.pred || !m.feitos || !m.pot || !m.dist || !saida) {
+        perror("(emparelhamentos_k_melhores) Erro ao allocar memoria.");
+        goto erro;
+    }
+    for(i = 0; i < n; ++i) {
+        if(vetor[i]->lado)
+            continue;
+        for(inicia_vizinhanca(&cur, vetor[i], VIZIN_COMPL); (a = proxima_incidente(&cur)); )
+            grande += a->peso < 0 ? -a->peso : a->peso;
+    }
+    for(i = 0; i < n; ++i) {
+        if(vetor[i]->lado)
+            continue;
+        r = col_de[i];
+        q = m.ini[r];
+        m.col[q] = m.n_col - n_lin + r;
+        m.custo[q] = perfeito ? grande : 0;
+        m.arco[q] = NULL;
+        m.linha[q++] = r;
+        for(inicia_vizinhanca(&cur, vetor[i], VIZIN_COMPL); (a = proxima_incidente(&cur)); ++q) {
+            w = outra_ponta(a, vetor[i]);
+            m.col[q] = col_de[w->atributo];
+            m.custo[q] = maximizar ? -a->peso : a->peso;
+            m.arco[q] = a;
+            m.linha[q] = r;
+        }
+    }
+    for(q = 0; q < m.ini[n_lin]; ++q)
+        if(q == 0 || m.custo[q] < minimo)
+            minimo = m.custo[q];
+
+    // Raiz: atribuicao otima, linha por linha, com potenciais iniciais
+    // viaveis (0 nas linhas, o menor custo nas colunas e no sorvedouro).
+    cap_nos = 16;
+    nos = ALOCA(MEM_ALGORITMOS, cap_nos * sizeof(struct sub_murty));
+    if(nos == NULL) {
+        perror("(emparelhamentos_k_melhores) Erro ao allocar memoria.");
+        goto erro;
+    }
+    m.carimbo = 1;
+    for(i = 0; i < m.n_nos; ++i)
+        m.pot[i] = i < n_lin ? 0 : minimo;
+    for(c = 0; c < m.n_col; ++c)
+        m.dono[c] = NENHUM;
+    for(r = 0; r < n_lin; ++r) {
+        m.arco_de[r] = NENHUM;
+        aumenta_murty(&m, r); // Sempre ha o arco ficticio.
+    }
+    s = &nos[n_nos++];
+    memset(s, 0, sizeof(struct sub_murty));
+    s->pai = s->arco = NENHUM;
+    s->resolvido = 1;
+    s->arco_de = ALOCA(MEM_ALGORITMOS, (n_lin + 1) * sizeof(unsigned int));
+    s->pot = ALOCA(MEM_ALGORITMOS, m.n_nos * sizeof(long int));
+    if(!s->arco_de || !s->pot) {
+        perror("(emparelhamentos_k_melhores) Erro ao allocar memoria.");
+        goto erro;
+    }
+    memcpy(s->arco_de, m.arco_de, n_lin * sizeof(unsigned int));
+    memcpy(s->pot, m.pot, m.n_nos * sizeof(long int));
+    for(r = 0; r < n_lin; ++r) {
+        s->custo += m.custo[m.arco_de[r]];
+        if(m.arco[m.arco_de[r]] == NULL)
+            ++ficticios;
+    }
+    insere_heap(&fila, s->custo, 0);
+
+    for(q = 0; q < k && fila.n; ) {
+        it = remove_heap(&fila);
+        s = &nos[it.x];
+        if(!s->resolvido) {
+            if(resolve_murty(&m, nos, s))
+                insere_heap(&fila, s->custo, it.x);
+            if(--nos[s->pai].filhos == 0) {
+                LIBERA(nos[s->pai].arco_de); nos[s->pai].arco_de = NULL;
+                LIBERA(nos[s->pai].pot); nos[s->pai].pot = NULL;
+            }
+            continue;
+        }
+
+        // Proxima melhor solucao: monta o grafo do emparelhamento.
+        for(c = 0, r = 0; r < n_lin; ++r)
+            if(m.arco[s->arco_de[r]] == NULL)
+                ++c;
+        if(perfeito && c > ficticios)
+            break; // Acabaram os emparelhamentos de tamanho maximo.
+        for(i = 0; i < n; ++i) {
+            vetor[i]->coberto = 0;
+            for(inicia_vizinhanca(&cur, vetor[i], VIZIN_SAIDA); (a = proxima_incidente(&cur)); )
+                a->coberta = 0;
+        }
+        for(peso = 0, r = 0; r < n_lin; ++r) {
+            if((a = m.arco[s->arco_de[r]])) {
+                a->coberta = a->vs->coberto = a->vc->coberto = 1;
+                peso += a->peso;
+            }
+        }
+        e = grafo_emparelhamento(g);
+        e->ponderado = g->ponderado;
+        insere_lista(e, saida);
+        if(pesos)
+            pesos[q] = peso;
+        ++q;
+
+        // Filhos: fixa as linhas [f, i) e proibe o arco atual da linha i.
+        for(i = s->f; i < n_lin; ++i) {
+            if(n_nos == cap_nos) {
+                cap_nos *= 2;
+                novo = REALOCA(MEM_ALGORITMOS, nos, cap_nos * sizeof(struct sub_murty));
+                if(novo == NULL) {
+                    perror("(emparelhamentos_k_melhores) Erro ao allocar memoria.");
+                    goto erro;
+                }
+                nos = novo;
+                s = &nos[it.x];
+            }
+            novo = &nos[n_nos];
+            memset(novo, 0, sizeof(struct sub_murty));
+            novo->custo = s->custo;
+            novo->pai = it.x;
+            novo->f = i;
+            novo->arco = s->arco_de[i];
+            ++s->filhos;
+            insere_heap(&fila, novo->custo, n_nos++);
+        }
+        if(s->filhos == 0) {
+            LIBERA(s->arco_de); s->arco_de = NULL;
+            LIBERA(s->pot); s->pot = NULL;
+        }
+    }
+
+    // insere_lista() insere no inicio: inverte pra deixar a melhor primeiro.
+    for(prim = NULL, x = primeiro_no(saida); x; x = prox) {
+        prox = x->proximo;
+        x->anterior = prox;
+        x->proximo = prim;
+        prim = x;
+    }
+    saida->primeiro = prim;
+    goto fim;
+
+erro:
+    destroi_lista(saida, destroi_grafo);
+    saida = NULL;
+fim:
+    for(i = 0; i < n_nos; ++i) {
+        LIBERA(nos[i].arco_de);
+        LIBERA(nos[i].pot);
+    }
+    LIBERA(nos); LIBERA(fila.item); LIBERA(vetor); LIBERA(col_de);
+    LIBERA(m.ini); LIBERA(m.col); LIBERA(m.linha); LIBERA(m.proib); LIBERA(m.custo); LIBERA(m.arco);
+    LIBERA(m.arco_de); LIBERA(m.dono); LIBERA(m.bloq); LIBERA(m.marca); LIBERA(m.pred);
+    LIBERA(m.feitos); LIBERA(m.pot); LIBERA(m.dist); LIBERA(m.h.item);
+    return saida;
+}
+
+grafo le_grafo(FILE *input) {
+    INICIA_FASE(t);
+    Agraph_t *g = agread(input, NULL);
+    Agnode_t *node;
+    Agedge_t *a;
+    char* aux;
+    char* attr = ALOCA(MEM_ES, sizeof(char) * TAM_NOME);
+    strcpy(attr,"peso");
+    long int peso = PESO_DEFAULT;
+    int v_alterado = 0;
+    vertice *tabela = NULL;
+    unsigned int tam;
+
+    // Fim da entrada (ou erro de sintaxe): agread devolve NULL.
+    if(g == NULL) {
+        LIBERA(attr);
+        return NULL;
+    }
+
+    grafo g2 = constroi_grafo();
+    if(g2 == NULL)
+        goto erro;
+
+    g2->direcao = agisdirected(g);
     // Nao da pra fazer g2->nome apontar pra agnameof(g), porque ele vai apontar pro nome da estrutura de grafo
     // da biblioteca, que vai ser desalocada no final desta função.
     strncpy(g2->nome, agnameof(g), TAM_NOME);
@@ -1251,16 +6383,23 @@ grafo le_grafo(FILE *input) {
         v = insere_vertice(g2, agnameof(node));
         if(v == NULL) {
             perror("(le_grafo) Erro ao inserir vertice no grafo.");
-            return NULL;
+            goto erro;
         }
     }
 
+    // Os vertices das arestas sao procurados pelo nome numa tabela de
+    // espalhamento: com procura_vertice a leitura seria quadratica.
+    if(!(tabela = tabela_nomes(g2, &tam))) {
+        perror("(le_grafo) Erro ao allocar memoria.");
+        goto erro;
+    }
+
     // Percorre todos os vertices para inserir todas as arestas.
     for(node=agfstnode(g); node; node=agnxtnode(g,node)) {
-        v = procura_vertice(g2, agnameof(node));
+        v = procura_tabela_nomes(tabela, tam, agnameof(node));
         if(v == NULL) {
             perror("(le_grafo) Vertice nao encontrado.");
-            return NULL;
+            goto erro;
         }
         // Percorre todas as arestas da estrutura, procurando os vertices de entrada (o vertice de saida eh v)
         // e insere na nossa estrutura, ou seja, na lista de vertices do grafo g2.
@@ -1270,11 +6409,11 @@ grafo le_grafo(FILE *input) {
             if(node == aghead(a)) {
                 v_aux = v;
                 aux = agnameof(agtail(a));
-                v = procura_vertice(g2, aux);
+                v = procura_tabela_nomes(tabela, tam, aux);
                 v_alterado = 1;
                 if(v == NULL) {
                     perror("(le_grafo) Vertice nao encontrado.");
-                    return NULL;
+                    goto erro;
                 }
                 char* aux2 = agget((void*)a,attr);
 
@@ -1287,9 +6426,9 @@ grafo le_grafo(FILE *input) {
                     g2->ponderado = 1;
 
                 // Insere ele como aresta do vertice v.
-                if(insere_aresta(v,v_aux,peso) == NULL) {
+                if(insere_aresta(g2,v,v_aux,peso) == NULL) {
                     perror("(le_grafo) Erro ao inserir aresta.");
-                    return NULL;
+                    goto erro;
                 }
 
                 if(v_alterado)
@@ -1300,14 +6439,31 @@ grafo le_grafo(FILE *input) {
     }
 
     agclose(g);
-    free(attr);
+    LIBERA(attr);
+    LIBERA(tabela);
 
+    // O hash canonico eh calculado na leitura (ver hash_grafo).
+    hash_grafo(g2);
+
+    CONTA(vertices_lidos, tamanho_lista(g2->v));
+    CONTA(arestas_lidas, g2->n_arestas);
+    TERMINA_FASE(FASE_LEITURA, t);
     return g2;
+
+erro:
+    // O grafo lido pela metade nao serve: libera tudo.
+    agclose(g);
+    LIBERA(attr);
+    LIBERA(tabela);
+    if(g2)
+        destroi_grafo(g2);
+    return NULL;
 }
 
 grafo escreve_grafo(FILE *output, grafo g) {
     if(g == NULL)
         return NULL;
+    INICIA_FASE(t);
 
     char direcao = g->direcao? '>' : '-';
     if(g->direcao)
@@ -1340,6 +6496,9 @@ grafo escreve_grafo(FILE *output, grafo g) {
 
     fprintf(output,"}\n");
 
+    CONTA(vertices_escritos, tamanho_lista(g->v));
+    CONTA(arestas_escritas, g->n_arestas);
+    TERMINA_FASE(FASE_ESCRITA, t);
     return g;
 }
 
@@ -62,11 +62,26 @@ lista constroi_lista(void);
 
 int destroi_lista(lista l, int destroi(void *));
 
+//------------------------------------------------------------------------------
+// desaloca a lista l e todos os seus nós, mas não o conteúdo deles
+//
+// l é um (void *) para que destroi_sublista() possa ser usada como argumento
+// de destroi_lista() ao desalocar uma lista de listas
+//
+// devolve 1 em caso de sucesso,
+//      ou 0 em caso de falha
+
+int destroi_sublista(void *l);
+
 //------------------------------------------------------------------------------
 // remove o no de endereço rno de l
 // se destroi != NULL, executa destroi(conteudo(rno)) 
 // devolve 1, em caso de sucesso
 //         0, se rno não for um no de l
+//
+// o tempo de execução é O(1); rno deve ser NULL ou um nó de alguma lista, e
+// o caso em que rno é de outra lista só é detectado se rno é o primeiro nó
+// dela
 
 int remove_no(struct lista *l, struct no *rno, int destroi(void *));
 
@@ -109,6 +124,8 @@ unsigned int n_vertices(grafo g);
 
 //------------------------------------------------------------------------------
 // devolve o número de arestas/arcos do grafo g
+//
+// o tempo de execução é O(1)
 
 unsigned int n_arestas(grafo g);
 
@@ -124,6 +141,58 @@ typedef struct vertice *vertice;
 
 char *nome_vertice(vertice v);
 
+//------------------------------------------------------------------------------
+// devolve a lista de vértices do grafo g
+
+lista vertices_grafo(grafo g);
+
+//------------------------------------------------------------------------------
+// devolve o vértice de nome nome do grafo g,
+//      ou NULL, se g não tem tal vértice
+
+vertice procura_vertice(grafo g, char *nome);
+
+//------------------------------------------------------------------------------
+// insere em g um vértice de nome nome (que g ainda não deve ter), sem
+// arestas
+//
+// devolve o vértice inserido ou
+//         NULL em caso de erro
+
+vertice insere_vertice(grafo g, char *nome);
+
+//------------------------------------------------------------------------------
+// insere em g a aresta {u,v} (ou o arco (u,v), se g é direcionado) com peso
+// peso
+//
+// devolve 1, se a aresta foi inserida, ou
+//         0, se u = v, se g já tem tal aresta ou em caso de erro
+
+int insere_aresta_entre(grafo g, vertice u, vertice v, long int peso);
+
+//------------------------------------------------------------------------------
+// remove de g a aresta {u,v} (ou o arco (u,v), se g é direcionado) e a
+// desaloca
+//
+// o tempo de execução é O(min(grau de saída de u, grau de entrada de v))
+// para encontrar a aresta e O(1) para removê-la
+//
+// devolve 1, se a aresta foi removida, ou
+//         0, se g não tem tal aresta
+
+int remove_aresta_entre(grafo g, vertice u, vertice v);
+
+//------------------------------------------------------------------------------
+// remove o vértice v de g, junto com todas as arestas que incidem nele, e o
+// desaloca
+//
+// o tempo de execução é O(grau de v)
+//
+// devolve 1 em caso de sucesso ou
+//         0 caso contrário
+
+int remove_vertice(grafo g, vertice v);
+
 //------------------------------------------------------------------------------
 // lê um grafo no formato dot de input, usando as rotinas de libcgraph
 // 
@@ -138,8 +207,10 @@ char *nome_vertice(vertice v);
 // todas as estruturas de dados alocadas pela libcgraph são
 // desalocadas ao final da execução
 // 
+// se input tem vários grafos concatenados, cada chamada lê o próximo
+// 
 // devolve o grafo lido ou
-//         NULL em caso de erro 
+//         NULL em caso de erro ou no fim de input
 
 grafo le_grafo(FILE *input);  
 
@@ -186,6 +257,39 @@ grafo copia_grafo(grafo g);
 
 lista vizinhanca(vertice v, int direcao, grafo g);
 
+//------------------------------------------------------------------------------
+// cursor para percorrer a vizinhança de um vértice sem alocar memória
+//
+// deve ser declarado pelo chamador (por exemplo, na pilha) e tratado como
+// opaco: seus campos só devem ser usados pelas funções abaixo
+
+typedef struct cursor_vizinhanca {
+  vertice v;
+  no atual;
+  int direcao;
+  int fase;
+} cursor_vizinhanca;
+
+//------------------------------------------------------------------------------
+// prepara o cursor c para percorrer a vizinhança do vértice v
+//
+// direcao tem o mesmo significado que em vizinhanca()
+//
+// o grafo não deve ser alterado enquanto o cursor estiver em uso
+
+void inicia_vizinhanca(cursor_vizinhanca *c, vertice v, int direcao);
+
+//------------------------------------------------------------------------------
+// devolve o próximo vizinho do cursor c,
+//      ou NULL, se a vizinhança já foi toda percorrida
+//
+// uso típico:
+//
+//     for(inicia_vizinhanca(&c, v, 0); (w = proximo_vizinho(&c)); )
+//       ...
+
+vertice proximo_vizinho(cursor_vizinhanca *c);
+
 //------------------------------------------------------------------------------
 // devolve o grau do vértice v no grafo g
 // 
@@ -197,6 +301,8 @@ lista vizinhanca(vertice v, int direcao, grafo g);
 //
 // se direcao == 1, v é um vértice de um grafo direcionado
 //                  e a função devolve seu grau de saída
+//
+// o tempo de execução é O(1)
 
 unsigned int grau(vertice v, int direcao, grafo g);
 
@@ -238,14 +344,819 @@ int ordem_perfeita_eliminacao(lista l, grafo g);
 
 int cordal(grafo g);
 
+//------------------------------------------------------------------------------
+// devolve uma lista de vértices com uma ordem perfeita de eliminação de g,
+//      se g é cordal, ou
+//         NULL, caso contrário
+//
+// a lista devolvida pode ser usada como argumento "ordem" das funções abaixo,
+// que valem apenas para grafos cordais e executam em tempo
+// O(|V(G)|+|E(G)|) (exceto arvore_cliques(), que também é linear no
+// tamanho das cliques)
+
+lista ordem_cordal(grafo g);
+
+//------------------------------------------------------------------------------
+// devolve uma lista de vértices que formam uma clique de tamanho máximo
+// no grafo cordal g, sendo ordem uma ordem perfeita de eliminação de g
+
+lista clique_maxima(lista ordem, grafo g);
+
+//------------------------------------------------------------------------------
+// devolve uma lista com as cliques maximais do grafo cordal g, sendo
+// ordem uma ordem perfeita de eliminação de g
+//
+// cada elemento da lista devolvida é uma lista de vértices; a lista pode
+// ser desalocada com destroi_lista(l, destroi_sublista)
+
+lista cliques_maximais(lista ordem, grafo g);
+
+//------------------------------------------------------------------------------
+// devolve uma árvore de cliques do grafo cordal g, sendo ordem uma ordem
+// perfeita de eliminação de g
+//
+// o vértice de nome "i" da árvore representa a i-ésima clique (contando a
+// partir de 0) da lista devolvida por cliques_maximais(ordem, g) e o peso
+// de cada aresta é o tamanho da interseção entre as duas cliques
+//
+// se g é desconexo, o grafo devolvido é uma floresta
+
+grafo arvore_cliques(lista ordem, grafo g);
+
+//------------------------------------------------------------------------------
+// devolve uma coloração ótima do grafo cordal g, sendo ordem uma ordem
+// perfeita de eliminação de g
+//
+// a coloração é devolvida como uma lista de classes de cor, cada uma delas
+// uma lista de vértices; o número de cores é o tamanho da lista devolvida,
+// que é igual ao tamanho da clique máxima de g
+//
+// a lista pode ser desalocada com destroi_lista(l, destroi_sublista)
+
+lista coloracao_otima(lista ordem, grafo g);
+
+//------------------------------------------------------------------------------
+// devolve uma lista de vértices que formam um conjunto independente de
+// tamanho máximo no grafo cordal g, sendo ordem uma ordem perfeita de
+// eliminação de g
+
+lista conjunto_independente_maximo(lista ordem, grafo g);
+
+//------------------------------------------------------------------------------
+// (apontador para) estrutura que acompanha se um grafo não direcionado
+// continua cordal à medida que arestas são inseridas e removidas
+
+typedef struct cordal_dinamico *cordal_dinamico;
+
+//------------------------------------------------------------------------------
+// devolve uma estrutura que acompanha a cordalidade de g, que deve ser
+// alterado apenas pelas funções abaixo enquanto a estrutura existir
+//
+// executa cordal(g) uma vez
+//
+// devolve NULL se g é direcionado ou em caso de erro
+
+cordal_dinamico constroi_cordal_dinamico(grafo g);
+
+//------------------------------------------------------------------------------
+// desaloca c (mas não o seu grafo)
+//
+// devolve 1 em caso de sucesso ou
+//         0 caso contrário
+
+int destroi_cordal_dinamico(cordal_dinamico c);
+
+//------------------------------------------------------------------------------
+// insere a aresta {u,v} no grafo de c, se ela ainda não existe
+//
+// devolve 1, se o grafo continua cordal,
+//         0, se não continua, ou
+//        -1, se não se sabe
+//
+// se o grafo era cordal, a resposta é calculada sem percorrer o grafo todo:
+// g+uv é cordal se e só se N(u)∩N(v) separa u de v em g, o que é testado
+// com duas buscas simultâneas a partir de u e de v que param quando uma
+// delas se esgota; o tempo de execução é proporcional à soma dos graus de u
+// e v mais o tamanho (com as arestas) do menor dos dois lados
+//
+// se não se sabia que o grafo era cordal, a resposta é -1 e nada é
+// calculado: a resposta fica para cordal_atual(c)
+
+int insere_aresta_cordal(cordal_dinamico c, vertice u, vertice v);
+
+//------------------------------------------------------------------------------
+// remove a aresta {u,v} do grafo de c, se ela existe
+//
+// devolve 1, se o grafo continua cordal,
+//         0, se não continua, ou
+//        -1, se não se sabe
+//
+// se o grafo era cordal, a resposta é calculada localmente: g-uv é cordal se
+// e só se N(u)∩N(v) é uma clique, e o tempo de execução é proporcional à
+// soma dos graus de u, de v e dos seus vizinhos comuns
+//
+// se não se sabia que o grafo era cordal, a resposta é -1 e nada é
+// calculado: a resposta fica para cordal_atual(c)
+
+int remove_aresta_cordal(cordal_dinamico c, vertice u, vertice v);
+
+//------------------------------------------------------------------------------
+// devolve 1, se o grafo de c é cordal, ou
+//         0, caso contrário
+//
+// a resposta é imediata se é conhecida desde a última alteração; caso
+// contrário (depois de alterações a partir de um grafo não cordal),
+// executa cordal() sobre o grafo, e esta é a única função de c que o faz
+
+int cordal_atual(cordal_dinamico c);
+
+//------------------------------------------------------------------------------
+// devolve 1 se g é bipartido, ou 0 caso contrário, em tempo O(|V(G)|+|E(G)|)
+//
+// se g é bipartido, cada vértice recebe um lado (0 ou 1), consultável com
+// lado_vertice(), de forma que toda aresta liga vértices de lados diferentes
+// e, em cada componente de g, o lado 0 tem no máximo tantos vértices quanto o
+// lado 1
+//
+// se g não é bipartido e ciclo_impar != NULL, *ciclo_impar recebe uma lista
+// dos vértices de um ciclo ímpar de g, na ordem do ciclo (o último vértice é
+// vizinho do primeiro); a lista pode ser desalocada com
+// destroi_lista(l, NULL)
+
+int bipartido(grafo g, lista *ciclo_impar);
+
+//------------------------------------------------------------------------------
+// devolve o lado (0 ou 1) de v calculado pela última chamada de bipartido()
+// no grafo de v
+
+int lado_vertice(vertice v);
+
+//------------------------------------------------------------------------------
+// devolve um grafo cujas arestas formam um preenchimento mínimo de g, isto é,
+// um conjunto F de arestas tal que g+F é cordal e nenhum subconjunto próprio
+// de F tem essa propriedade (algoritmo MCS-M)
+//
+// os vértices do grafo devolvido são cópias dos vértices de g que são pontas
+// de arestas de F; se g é cordal, o grafo devolvido é vazio
+//
+// se ordem != NULL, *ordem recebe uma lista dos vértices de g com uma ordem
+// perfeita de eliminação de g+F
+//
+// o tempo de execução é O(|V(G)|·|E(G)|) e, além do grafo devolvido, usa
+// memória O(|V(G)|)
+//
+// devolve NULL se g é direcionado ou em caso de erro
+
+grafo triangulacao_minima(grafo g, lista *ordem);
+
 //------------------------------------------------------------------------------
 // devolve um grafo cujos vertices são cópias de vértices do grafo
 // bipartido g e cujas arestas formam um emparelhamento máximo em g
 //
 // o grafo devolvido, portanto, é vazio ou tem todos os vértices com grau 1
 //
-// não verifica se g é bipartido; caso não seja, o comportamento é indefinido
+// as buscas por caminhos aumentantes partem só dos vértices do lado 0 (o
+// menor de cada componente, ver bipartido())
+//
+// devolve NULL, sem mensagem de erro, se g não é bipartido (para grafos
+// quaisquer, use emparelhamento_geral()); um ciclo ímpar de g, que mostra
+// por que g não é bipartido, é obtido com bipartido(g, &ciclo), e o mesmo
+// vale para as demais funções que exigem um grafo bipartido
 
 grafo emparelhamento_maximo(grafo g);
 
+//------------------------------------------------------------------------------
+// devolve um emparelhamento máximo do grafo bipartido g, no mesmo formato
+// devolvido por emparelhamento_maximo(), resolvendo cada componente conexa
+// de g independentemente com até n_threads threads (0 conta como 1)
+//
+// componentes grandes são resolvidas uma de cada vez, com todas as threads
+// buscando caminhos aumentantes disjuntos simultaneamente; as demais são
+// distribuídas entre as threads, da maior para a menor, com roubo de
+// trabalho; componentes em que um dos lados tem um só vértice são
+// resolvidas diretamente
+//
+// usa memória O(|V(G)| + |E(G)|) além do grafo devolvido, mais
+// O(n_threads·|V(C)|) se houver componente C grande
+//
+// devolve NULL se g não é bipartido ou em caso de erro
+
+grafo emparelhamento_componentes(grafo g, unsigned int n_threads);
+
+//------------------------------------------------------------------------------
+// devolve um emparelhamento do grafo bipartido g, no mesmo formato devolvido
+// por emparelhamento_maximo(), com pelo menos (1 - epsilon) vezes o tamanho
+// de um emparelhamento máximo
+//
+// usa fases de Hopcroft-Karp, parando quando os caminhos aumentantes
+// restantes têm mais de (1 - epsilon)/epsilon arestas do emparelhamento;
+// são O(1/epsilon) fases de tempo O(|E(G)|) cada (com epsilon <= 0, vai até
+// o emparelhamento máximo)
+//
+// se razao não é NULL, *razao recebe um limite inferior garantido para a
+// razão entre o tamanho do emparelhamento devolvido e o de um máximo (1 se
+// o emparelhamento devolvido é máximo), que pode ser melhor que 1 - epsilon
+//
+// devolve NULL se g não é bipartido ou em caso de erro
+
+grafo emparelhamento_aproximado(grafo g, double epsilon, double *razao);
+
+//------------------------------------------------------------------------------
+// devolve o melhor emparelhamento do grafo bipartido g encontrado em até
+// prazo segundos (relógio de parede; prazo <= 0 significa sem prazo), no
+// mesmo formato devolvido por emparelhamento_maximo()
+//
+// se cancelar não é NULL, a busca também para assim que *cancelar for
+// diferente de 0 (por exemplo, alterado por outra thread)
+//
+// o prazo e o cancelamento são conferidos entre um caminho aumentante e
+// outro; depois disso, ainda são gastos O(|E(G)|) para montar a resposta
+//
+// se limite_superior não é NULL, *limite_superior recebe um limite superior
+// para o tamanho de um emparelhamento máximo de g, obtido de uma cobertura
+// por vértices (igual ao tamanho do devolvido se este é máximo)
+//
+// devolve NULL se g não é bipartido ou em caso de erro
+
+grafo emparelhamento_com_prazo(grafo g, double prazo, volatile int *cancelar, unsigned int *limite_superior);
+
+//------------------------------------------------------------------------------
+// devolve um grafo com um emparelhamento do grafo cujas arestas estão no
+// arquivo arestas, uma por linha ("u v" ou "u -- v", com nomes de até
+// TAM_NOME-1 caracteres; linhas vazias ou começadas por # são ignoradas),
+// sem nunca guardar as arestas na memória
+//
+// o arquivo é lido do início várias vezes, então precisa permitir fseek()
+// (um arquivo comum, ou a entrada padrão redirecionada de um arquivo)
+//
+// a primeira leitura dá um emparelhamento maximal e os lados do grafo; se o
+// grafo é bipartido, cada leitura seguinte avança uma camada de uma busca
+// por caminhos aumentantes mínimos, até que o emparelhamento seja máximo ou
+// tenha pelo menos (1 - epsilon) vezes o tamanho de um máximo (com
+// epsilon <= 0, vai até o máximo); se não é bipartido, devolve o maximal
+//
+// se razao não é NULL, *razao recebe um limite inferior garantido para a
+// razão entre o tamanho do emparelhamento devolvido e o de um máximo (1/2
+// se o grafo não é bipartido); se passadas não é NULL, *passadas recebe o
+// número de leituras do arquivo
+//
+// usa memória O(|V(G)|), independente do número de arestas
+//
+// devolve NULL se o arquivo não pode ser relido ou em caso de erro
+
+grafo emparelhamento_em_passadas(FILE *arestas, double epsilon, double *razao, unsigned int *passadas);
+
+//------------------------------------------------------------------------------
+// (apontador para) grafo guardado num arquivo em disco, mapeado em memória
+// (mmap) e trazido do disco sob demanda
+//
+// os vértices são numerados de 0 a n_vertices_externo()-1 na ordem de uma
+// busca em largura, de modo que vértices próximos no grafo têm as suas
+// vizinhanças próximas no arquivo
+
+typedef struct grafo_externo *grafo_externo;
+
+//------------------------------------------------------------------------------
+// cria o arquivo de nome arquivo com o grafo cujas arestas estão no arquivo
+// arestas (no formato de emparelhamento_em_passadas()) e devolve o grafo
+// externo correspondente, aberto
+//
+// o arquivo arestas é lido do início três vezes; só são guardados na memória
+// vetores com O(|V(G)|) elementos
+//
+// devolve NULL em caso de erro
+
+grafo_externo constroi_grafo_externo(FILE *arestas, const char *arquivo);
+
+//------------------------------------------------------------------------------
+// abre o grafo externo guardado no arquivo de nome arquivo, criado por
+// constroi_grafo_externo()
+//
+// devolve NULL se o arquivo não existe ou não é um grafo externo
+
+grafo_externo abre_grafo_externo(const char *arquivo);
+
+//------------------------------------------------------------------------------
+// fecha o grafo externo g (o arquivo continua em disco)
+//
+// devolve 1 em caso de sucesso ou 0 caso contrário
+
+int destroi_grafo_externo(grafo_externo g);
+
+//------------------------------------------------------------------------------
+// devolve o número de vértices do grafo externo g
+
+unsigned int n_vertices_externo(grafo_externo g);
+
+//------------------------------------------------------------------------------
+// devolve o nome do vértice de número x do grafo externo g
+
+const char *nome_vertice_externo(grafo_externo g, unsigned int x);
+
+//------------------------------------------------------------------------------
+// devolve o grau do vértice de número x do grafo externo g e faz *vizinhos
+// apontar para os números dos seus vizinhos, guardados no arquivo
+
+unsigned int vizinhos_externo(grafo_externo g, unsigned int x, const unsigned int **vizinhos);
+
+//------------------------------------------------------------------------------
+// devolve um emparelhamento do grafo externo bipartido g, no formato de
+// emparelhamento_em_passadas(), com as mesmas fases e garantias de
+// emparelhamento_aproximado() (com epsilon <= 0, é máximo)
+//
+// a vizinhança é lida diretamente do arquivo mapeado; as páginas são pedidas
+// ao sistema à frente da fila da busca em largura de cada fase
+//
+// usa memória O(|V(G)|) além das páginas do arquivo
+//
+// devolve NULL se g não é bipartido ou em caso de erro
+
+grafo emparelhamento_externo(grafo_externo g, double epsilon, double *razao);
+
+//------------------------------------------------------------------------------
+// meio de comunicação entre o coordenador e as partes (processos
+// trabalhadores) de emparelhamento_distribuido()
+//
+// do lado do coordenador, parte é o número da parte (de 0 a n_partes-1); do
+// lado de cada trabalhador, é sempre 0 (o coordenador)
+//
+// envia() manda os n inteiros de dados e recebe() espera exatamente n
+// inteiros em dados; as duas devolvem 0 em caso de erro; a ordem das
+// mensagens entre dois lados deve ser preservada
+//
+// dados é livre para uso da implementação (sockets, memória compartilhada,
+// rede, etc)
+
+typedef struct transporte {
+  int (*envia)(struct transporte *t, unsigned int parte, const unsigned int *dados, unsigned int n);
+  int (*recebe)(struct transporte *t, unsigned int parte, unsigned int *dados, unsigned int n);
+  void *dados;
+} transporte;
+
+//------------------------------------------------------------------------------
+// devolve um emparelhamento máximo do grafo bipartido cujas arestas estão no
+// arquivo arestas (no formato de emparelhamento_em_passadas()), no mesmo
+// formato devolvido por emparelhamento_em_passadas()
+//
+// os vértices são divididos entre n_partes trabalhadores (o vértice de
+// número x fica na parte x % n_partes) e cada aresta é guardada só pela
+// parte do seu vértice do lado 0; cada parte começa com um emparelhamento
+// máximo das suas arestas internas e, depois, o coordenador procura caminhos
+// aumentantes entre as partes, pedindo a cada camada da busca em largura que
+// cada parte expanda os seus vértices
+//
+// se t é NULL, as partes são processos criados com fork() e ligados ao
+// coordenador por sockets Unix; senão, cada parte já deve estar executando
+// trabalhador_emparelhamento() do outro lado de t
+//
+// com t NULL, o processo que chama não pode ter outras threads executando:
+// cada parte criada com fork() tem só a thread que chamou e aloca memória,
+// e uma trava (do malloc(), por exemplo) que outra thread segurava no
+// fork() ficaria travada para sempre na parte; com outras threads, crie as
+// partes antes delas ou use um transporte t
+//
+// as mensagens têm no máximo 4096 arestas ou O(|V(G)|) inteiros, então o
+// coordenador usa memória O(|V(G)|) e cada parte, O(|V(G)|) mais as suas
+// arestas
+//
+// devolve NULL se o grafo não é bipartido, se o arquivo não pode ser relido
+// ou em caso de erro de memória ou de comunicação
+
+grafo emparelhamento_distribuido(FILE *arestas, unsigned int n_partes, transporte *t);
+
+//------------------------------------------------------------------------------
+// atende ao coordenador de emparelhamento_distribuido() do outro lado de t
+// até que ele encerre
+//
+// devolve 1 se o coordenador encerrou normalmente ou 0 em caso de erro
+
+int trabalhador_emparelhamento(transporte *t);
+
+//------------------------------------------------------------------------------
+// devolve um grafo cujos vertices são cópias de vértices do grafo g, bipartido
+// ou não, e cujas arestas formam um emparelhamento máximo em g, no mesmo
+// formato devolvido por emparelhamento_maximo()
+//
+// usa o algoritmo de Edmonds (contração de florações), em tempo
+// O(|V(G)|·|E(G)|·α(|V(G)|)) e memória O(|V(G)|) além do grafo devolvido
+
+grafo emparelhamento_geral(grafo g);
+
+//------------------------------------------------------------------------------
+// devolve um grafo com um emparelhamento de peso ótimo do grafo bipartido g,
+// no mesmo formato devolvido por emparelhamento_maximo(), usando os pesos
+// lidos do atributo "peso"
+//
+// se maximizar != 0, o emparelhamento tem peso máximo; senão, peso mínimo
+//
+// se perfeito != 0, o emparelhamento tem peso ótimo dentre os emparelhamentos
+// de tamanho máximo (em particular, se g tem emparelhamento perfeito, o
+// devolvido é perfeito); senão, tem peso ótimo dentre todos os
+// emparelhamentos de g, de qualquer tamanho
+//
+// se peso_total != NULL, *peso_total recebe a soma dos pesos das arestas do
+// emparelhamento
+//
+// usa caminhos aumentantes mais curtos com Dijkstra sobre custos reduzidos, em
+// tempo O(k·|E(G)|·log|V(G)|), onde k é o tamanho do emparelhamento
+//
+// devolve NULL se g não é bipartido ou em caso de erro
+
+grafo emparelhamento_ponderado(grafo g, int maximizar, int perfeito, long int *peso_total);
+
+//------------------------------------------------------------------------------
+// devolve um grafo com um emparelhamento de peso ótimo (máximo se
+// maximizar != 0, mínimo senão) dentre todos os emparelhamentos do grafo
+// bipartido g, no mesmo formato devolvido por emparelhamento_maximo(),
+// usando o algoritmo de leilão com escalonamento de ε
+//
+// os lances são calculados em paralelo por n_threads threads (rodadas de
+// Jacobi) enquanto há muitos licitantes livres, e um a um (Gauss-Seidel) no
+// final de cada fase; n_threads <= 1 usa só Gauss-Seidel
+//
+// o escalonamento para quando a diferença provada entre o peso devolvido e o
+// ótimo é no máximo folga_maxima; folga_maxima = 0 executa a fase final
+// exata e devolve um emparelhamento ótimo (o mesmo peso de
+// emparelhamento_ponderado(g, maximizar, 0, ...))
+//
+// se peso_total != NULL, *peso_total recebe a soma dos pesos das arestas do
+// emparelhamento; se folga != NULL, *folga recebe o limite provado da
+// distância do peso devolvido até o ótimo
+//
+// devolve NULL se g não é bipartido ou em caso de erro
+
+grafo emparelhamento_leilao(grafo g, int maximizar, unsigned int n_threads, long int folga_maxima, long int *peso_total, long int *folga);
+
+//------------------------------------------------------------------------------
+// devolve uma lista com os k emparelhamentos de melhor peso do grafo
+// bipartido g (ou todos, se g tiver menos de k), em ordem do melhor para o
+// pior, cada um no formato devolvido por emparelhamento_maximo()
+//
+// maximizar e perfeito têm o mesmo significado que em
+// emparelhamento_ponderado(): com perfeito != 0 só são listados
+// emparelhamentos de tamanho máximo
+//
+// se pesos != NULL, pesos[i] recebe o peso do i-ésimo emparelhamento da
+// lista; pesos deve ter espaço para k valores
+//
+// usa o particionamento de Murty; cada subproblema é resolvido a partir da
+// solução e dos potenciais do subproblema pai, com no máximo dois caminhos
+// mínimos, e só quando sai da fila de prioridade
+//
+// a lista pode ser desalocada com destroi_lista(l, destroi_grafo)
+//
+// devolve NULL se g não é bipartido ou em caso de erro
+
+lista emparelhamentos_k_melhores(grafo g, int maximizar, int perfeito, unsigned int k, long int *pesos);
+
+//------------------------------------------------------------------------------
+// (apontador para) estrutura que mantém um emparelhamento máximo de um grafo
+// bipartido à medida que arestas são inseridas e removidas
+
+typedef struct emparelhamento_dinamico *emparelhamento_dinamico;
+
+//------------------------------------------------------------------------------
+// calcula um emparelhamento máximo do grafo bipartido g e devolve uma
+// estrutura que o mantém; g deve ser alterado apenas pelas funções abaixo
+// enquanto a estrutura existir
+//
+// devolve NULL se g não é bipartido ou em caso de erro
+
+emparelhamento_dinamico constroi_emparelhamento_dinamico(grafo g);
+
+//------------------------------------------------------------------------------
+// desaloca d (mas não o seu grafo)
+//
+// devolve 1 em caso de sucesso ou
+//         0 caso contrário
+
+int destroi_emparelhamento_dinamico(emparelhamento_dinamico d);
+
+//------------------------------------------------------------------------------
+// insere a aresta {u,v} com peso peso no grafo de d e atualiza o
+// emparelhamento
+//
+// faz no máximo uma busca por caminho aumentante a partir de cada ponta da
+// aresta
+//
+// devolve o tamanho do emparelhamento máximo depois da inserção
+
+unsigned int insere_aresta_emparelhamento(emparelhamento_dinamico d, vertice u, vertice v, long int peso);
+
+//------------------------------------------------------------------------------
+// remove a aresta {u,v} do grafo de d, se ela existe, e atualiza o
+// emparelhamento
+//
+// se a aresta estava no emparelhamento, procura caminhos aumentantes apenas
+// a partir de u e de v
+//
+// devolve o tamanho do emparelhamento máximo depois da remoção
+
+unsigned int remove_aresta_emparelhamento(emparelhamento_dinamico d, vertice u, vertice v);
+
+//------------------------------------------------------------------------------
+// configura as chegadas de vértices em d (ver chegada_emparelhamento())
+//
+// limite é o número máximo de arestas dos caminhos aumentantes procurados a
+// cada chegada (0 para não limitar; 1 para apenas emparelhar com um vizinho
+// livre, sem reatribuir vértices já emparelhados)
+//
+// a cada periodo chegadas (0 para nunca), executa
+// reotimiza_emparelhamento(d)
+//
+// o default é limite = 0 e periodo = 0, ou seja, cada chegada mantém o
+// emparelhamento máximo
+
+void limita_chegadas(emparelhamento_dinamico d, unsigned int limite, unsigned int periodo);
+
+//------------------------------------------------------------------------------
+// insere no grafo de d um vértice de nome nome com arestas para os vértices
+// da lista vizinhos e tenta emparelhá-lo imediatamente, com uma busca por
+// caminho aumentante a partir dele
+//
+// vértices que já estavam emparelhados continuam emparelhados, mas podem
+// trocar de par
+//
+// se a busca é limitada (ver limita_chegadas()), o emparelhamento pode
+// deixar de ser máximo até a próxima reotimização; nesse caso,
+// insere_aresta_emparelhamento() e remove_aresta_emparelhamento() mantêm um
+// emparelhamento válido, mas não necessariamente máximo
+//
+// devolve o vértice emparelhado com o novo vértice,
+//      ou NULL, se ele ficou livre ou em caso de erro
+
+vertice chegada_emparelhamento(emparelhamento_dinamico d, char *nome, lista vizinhos);
+
+//------------------------------------------------------------------------------
+// torna máximo o emparelhamento de d, aumentando-o a partir do emparelhamento
+// atual (e não do vazio), com uma busca a partir de cada vértice livre
+//
+// não faz nada se nenhuma busca limitada falhou desde a última reotimização
+//
+// devolve o tamanho do emparelhamento
+
+unsigned int reotimiza_emparelhamento(emparelhamento_dinamico d);
+
+//------------------------------------------------------------------------------
+// devolve o tamanho do emparelhamento mantido por d
+
+unsigned int tamanho_emparelhamento(emparelhamento_dinamico d);
+
+//------------------------------------------------------------------------------
+// devolve o vértice emparelhado com v em d,
+//      ou NULL, se v não está coberto pelo emparelhamento
+
+vertice par(emparelhamento_dinamico d, vertice v);
+
+//------------------------------------------------------------------------------
+// devolve um grafo com o emparelhamento mantido por d, no mesmo formato
+// devolvido por emparelhamento_maximo()
+
+grafo emparelhamento_atual(emparelhamento_dinamico d);
+
+//------------------------------------------------------------------------------
+// devolve o hash canônico de g
+//
+// o hash depende só do grafo ser direcionado ou não, dos nomes dos vértices
+// e das arestas com seus pesos, e não da ordem em que eles aparecem; dois
+// grafos lidos de arquivos que só diferem na ordem das linhas têm o mesmo
+// hash
+//
+// é calculado por le_grafo() e recalculado na primeira chamada depois de
+// alguma alteração em g
+
+unsigned long long hash_grafo(grafo g);
+
+//------------------------------------------------------------------------------
+// cache de resultados indexado pelo hash canônico dos grafos
+
+typedef struct cache_grafo *cache_grafo;
+
+//------------------------------------------------------------------------------
+// constrói um cache de resultados vazio
+//
+// o cache guarda no máximo limite bytes de resultados (ou 64 MiB, se
+// limite é 0); quando um resultado novo não cabe, os resultados consultados
+// há mais tempo são descartados (e calculados de novo se consultados
+// outra vez); um resultado maior que limite sozinho fica até o próximo
+//
+// se arquivo não é NULL, os resultados guardados nele são carregados (os
+// mais recentes, até o limite) e cada resultado novo é acrescentado a ele;
+// o arquivo é criado se não existe e não é afetado pelo limite; um
+// registro inconsistente no arquivo é cortado fora junto com os seguintes
+//
+// o cache pode ser usado por várias threads ao mesmo tempo (com grafos
+// diferentes)
+//
+// devolve o cache construído,
+//      ou NULL em caso de erro
+
+cache_grafo constroi_cache_grafo(const char *arquivo, size_t limite);
+
+//------------------------------------------------------------------------------
+// desaloca o cache c e fecha o seu arquivo
+//
+// devolve 1 em caso de sucesso,
+//      ou 0 caso contrário
+
+int destroi_cache_grafo(cache_grafo c);
+
+//------------------------------------------------------------------------------
+// igual a emparelhamento_maximo(), mas devolve o resultado guardado em c se
+// algum grafo com o mesmo hash canônico de g já foi calculado, sem alterar g
+// (em particular, sem atualizar lado_vertice())
+//
+// se o grafo guardado tinha os vértices em outra ordem, o emparelhamento
+// devolvido pode não ser o que emparelhamento_maximo(g) devolveria, mas é
+// máximo do mesmo jeito
+//
+// devolve NULL, sem mensagem de erro, se g não é bipartido
+
+grafo emparelhamento_maximo_cache(cache_grafo c, grafo g);
+
+//------------------------------------------------------------------------------
+// igual a busca_largura_lexicografica(), mas usando o cache c como
+// emparelhamento_maximo_cache()
+
+lista busca_largura_lexicografica_cache(cache_grafo c, grafo g);
+
+//------------------------------------------------------------------------------
+// igual a cordal(), mas usando o cache c como emparelhamento_maximo_cache();
+// a busca em largura lexicográfica calculada também é guardada em c
+
+int cordal_cache(cache_grafo c, grafo g);
+
+//------------------------------------------------------------------------------
+// devolve em *acertos e *faltas o número de consultas a c que foram e que
+// não foram respondidas pelo cache
+
+void estatisticas_cache(cache_grafo c, unsigned int *acertos, unsigned int *faltas);
+
+//------------------------------------------------------------------------------
+// devolve um vetor par com |V(g)| posições em que, sendo u o i-ésimo vértice
+// de vertices_grafo(g), par[i] é a posição do vértice emparelhado com u em
+// emparelhamento (um grafo devolvido por emparelhamento_maximo() ou uma das
+// funções análogas, ou um emparelhamento lido com le_grafo(), cujos
+// vértices são associados aos de g pelo nome), ou UINT_MAX se u está livre
+//
+// arestas de emparelhamento com uma ponta que não está em g são ignoradas,
+// de modo que o emparelhamento de uma versão anterior de g também serve de
+// ponto de partida para continua_emparelhamento()
+//
+// o vetor deve ser liberado com free()
+//
+// devolve NULL em caso de erro
+
+unsigned int *pares_emparelhamento(grafo g, grafo emparelhamento);
+
+//------------------------------------------------------------------------------
+// lê de f um vetor de pares de g gravado no formato binário de emparelha -f
+// pares e dos pontos de controle de continua_emparelhamento(): |V(g)| e os
+// |V(g)| elementos do vetor (ver pares_emparelhamento()), como inteiros sem
+// sinal de 32 bits na ordem da máquina
+//
+// o vetor deve ser liberado com free()
+//
+// devolve NULL se o número de vértices gravado não é |V(g)| ou em caso de
+// erro
+
+unsigned int *le_pares_emparelhamento(FILE *f, grafo g);
+
+//------------------------------------------------------------------------------
+// devolve um emparelhamento máximo do grafo bipartido g, como
+// emparelhamento_maximo(), mas começando do emparelhamento dado pelo vetor
+// par (ver pares_emparelhamento()), em vez de começar do vazio
+//
+// os pares de par que não formam um emparelhamento de g (par[par[i]] != i,
+// vértices do mesmo lado ou que não são vizinhos) são descartados; se
+// invalidos não é NULL, *invalidos recebe o número de vértices cujo par foi
+// descartado; par == NULL é o mesmo que começar do vazio
+//
+// se ponto_controle não é NULL, o vetor de pares do emparelhamento atual é
+// gravado no arquivo de nome ponto_controle (no formato de
+// le_pares_emparelhamento()) a cada intervalo segundos e no fim; assim, se
+// a execução é interrompida, a próxima pode continuar do último ponto de
+// controle; cada gravação escreve num arquivo temporário e o renomeia, de
+// modo que o ponto de controle anterior nunca fica pela metade
+//
+// o intervalo é conferido entre um caminho aumentante e outro; com
+// intervalo <= 0, o ponto de controle só é gravado no fim
+//
+// devolve NULL se g não é bipartido ou em caso de erro
+
+grafo continua_emparelhamento(grafo g, const unsigned int *par, const char *ponto_controle,
+                              double intervalo, unsigned int *invalidos);
+
+//------------------------------------------------------------------------------
+// fases cronometradas pelos contadores de desempenho
+
+enum fase {
+  FASE_LEITURA,        // le_grafo()
+  FASE_ESCRITA,        // escreve_grafo()
+  FASE_BIPARTIDO,      // bipartido()
+  FASE_BUSCA,          // caminhos aumentantes de emparelhamento_maximo()
+  FASE_COPIA,          // montagem do grafo devolvido pelos emparelhamentos
+  FASE_LEXICOGRAFICA,  // busca_largura_lexicografica()
+  FASE_OPE,            // ordem_perfeita_eliminacao()
+  N_FASES
+};
+
+//------------------------------------------------------------------------------
+// contadores de desempenho
+//
+// buscas e aumentos contam as buscas por caminho aumentante (ou, no
+// leilão, os lances) e as que aumentaram o emparelhamento, em todos os
+// algoritmos de emparelhamento; arestas_examinadas, as arestas percorridas
+// por essas buscas; marcas, as marcas de vértices reservadas pelas buscas
+// (cada uma evita reiniciar todos os vértices), e reinicios, as vezes em
+// que as marcas acabaram e todos os vértices foram reiniciados;
+// fases_camadas, as fases de Hopcroft-Karp (também as dos emparelhamentos
+// em passadas e distribuído); comparacoes_rotulo, as comparações de rótulos
+// da busca em largura lexicográfica
+//
+// tempo[f] e chamadas[f] são o tempo total, em segundos, e o número de
+// execuções da fase f
+
+typedef struct contadores {
+  unsigned long buscas, aumentos, arestas_examinadas, marcas, reinicios, fases_camadas,
+    comparacoes_rotulo, vertices_lidos, arestas_lidas, vertices_escritos, arestas_escritas;
+  unsigned long chamadas[N_FASES];
+  double tempo[N_FASES];
+} contadores;
+
+//------------------------------------------------------------------------------
+// passa a somar em c (que não é zerado) os contadores das funções chamadas
+// por esta thread; c == NULL desliga os contadores
+//
+// as threads criadas pelas funções paralelas somam em c o que contaram ao
+// terminar; os processos de emparelhamento_distribuido() não contam
+//
+// os contadores só existem se grafo.c é compilado com -DCONTADORES (make
+// CONTADORES=1); sem isso, nada é contado e os algoritmos não têm custo
+// nenhum a mais
+//
+// devolve 1 se os contadores foram compilados,
+//      ou 0 caso contrário
+
+int liga_contadores(contadores *c);
+
+//------------------------------------------------------------------------------
+// escreve c em f como um objeto JSON (sem quebra de linha no final)
+//
+// devolve 1 em caso de sucesso,
+//      ou 0 caso contrário
+
+int escreve_contadores(FILE *f, const contadores *c);
+
+//------------------------------------------------------------------------------
+// partes da biblioteca a que a memória alocada é atribuída
+
+enum memoria {
+  MEM_GRAFO,       // grafos, vértices e arestas (inclusive as cópias)
+  MEM_LISTAS,      // listas e seus nós
+  MEM_ALGORITMOS,  // estruturas auxiliares dos algoritmos
+  MEM_ES,          // leitura, cache, grafos externos e mensagens
+  MEM_TOTAL,       // soma das anteriores
+  N_MEMORIAS
+};
+
+//------------------------------------------------------------------------------
+// uso de memória de uma parte da biblioteca
+//
+// vivos e pico são os bytes alocados agora e o máximo deles desde o início
+// (ou desde reinicia_pico_memoria()); alocacoes e liberacoes contam as
+// chamadas
+
+typedef struct uso_memoria {
+  unsigned long vivos, pico, alocacoes, liberacoes;
+} uso_memoria;
+
+//------------------------------------------------------------------------------
+// copia em u o uso de memória de cada parte da biblioteca, somado em todas
+// as threads
+//
+// a contagem só existe se grafo.c é compilado com -DMEMORIA (make
+// MEMORIA=1); sem isso, a biblioteca usa malloc() e free() diretamente e u
+// fica zerado
+//
+// devolve 1 se a contagem foi compilada,
+//      ou 0 caso contrário
+
+int consulta_memoria(uso_memoria u[N_MEMORIAS]);
+
+//------------------------------------------------------------------------------
+// faz o pico de cada parte voltar a ser o que está alocado agora, para medir
+// o pico de um trecho só
+
+void reinicia_pico_memoria(void);
+
+//------------------------------------------------------------------------------
+// escreve o uso de memória em f como um objeto JSON (sem quebra de linha no
+// final)
+//
+// devolve 1 em caso de sucesso,
+//      ou 0 caso contrário
+
+int escreve_memoria(FILE *f);
+
 #endif
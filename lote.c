@@ -0,0 +1,293 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "grafo.h"
+
+//------------------------------------------------------------------------------
+// calcula emparelhamentos de muitos grafos numa execução só
+//
+// uso: lote [-t threads] [-l lista] [arquivo ...]
+//
+// lê os grafos (formato dot; um arquivo pode ter vários grafos
+// concatenados) dos arquivos dados, dos arquivos listados em lista (um por
+// linha, "-" é a entrada padrão) ou, se não há nenhum dos dois, da entrada
+// padrão
+//
+// escreve, na ordem da entrada, um emparelhamento máximo de cada grafo
+// (como teste), precedido da linha
+//
+//   // <indice> <nome> <vertices> <arestas> <tamanho do emparelhamento>
+//
+// de modo que a saída também é uma sequência de grafos no formato dot
+//
+// leitura, emparelhamento e escrita executam ao mesmo tempo: uma thread lê
+// os próximos grafos (a libcgraph não pode ser usada por várias threads),
+// threads threads (por padrão, uma por processador) emparelham os que já
+// foram lidos e a thread principal escreve os que ficaram prontos; no
+// máximo JANELA_POR_THREAD * threads grafos ficam na memória
+
+#define JANELA_POR_THREAD 8
+
+//------------------------------------------------------------------------------
+// grafo da janela; a posição de cada grafo é o seu índice na entrada módulo
+// o tamanho da janela
+
+struct tarefa {
+  grafo g, emparelhamento;
+  int pronta, padding;
+};
+
+static struct tarefa *janela = NULL;
+static unsigned long tam_janela = 0;
+
+// índices do próximo grafo a ler, a emparelhar e a escrever
+static unsigned long lidos = 0, emparelhando = 0, escritos = 0;
+static int fim_leitura = 0, erro_leitura = 0, erro = 0;
+
+static pthread_mutex_t trava = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tem_espaco = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t tem_grafo = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t tem_pronta = PTHREAD_COND_INITIALIZER;
+
+static char **arquivos = NULL;
+static int n_arquivos = 0;
+static const char *arquivo_lista = NULL;
+
+//------------------------------------------------------------------------------
+// põe g na janela, esperando uma posição livre
+
+static void enfileira(grafo g) {
+
+  pthread_mutex_lock(&trava);
+  while ( lidos - escritos == tam_janela )
+    pthread_cond_wait(&tem_espaco, &trava);
+  janela[lidos % tam_janela].g = g;
+  janela[lidos % tam_janela].emparelhamento = NULL;
+  janela[lidos % tam_janela].pronta = 0;
+  ++lidos;
+  pthread_cond_signal(&tem_grafo);
+  pthread_mutex_unlock(&trava);
+}
+
+//------------------------------------------------------------------------------
+// lê e enfileira todos os grafos de f
+
+static void le_arquivo(FILE *f, const char *nome) {
+
+  unsigned long n = 0;
+  grafo g;
+
+  while ( (g = le_grafo(f)) ) {
+
+    enfileira(g);
+    ++n;
+  }
+
+  if ( !feof(f) ) {
+
+    fprintf(stderr, "lote: erro em %s depois de %lu grafos\n", nome, n);
+    erro_leitura = 1;
+  }
+}
+
+//------------------------------------------------------------------------------
+// abre e lê o arquivo de nome nome ("-" é a entrada padrão)
+
+static void le_nome(const char *nome) {
+
+  FILE *f = strcmp(nome, "-") ? fopen(nome, "r") : stdin;
+
+  if ( !f ) {
+
+    perror(nome);
+    erro_leitura = 1;
+    return;
+  }
+  le_arquivo(f, nome);
+  if ( f != stdin )
+    fclose(f);
+}
+
+//------------------------------------------------------------------------------
+// thread de leitura
+
+static void *thread_leitura(void *arg) {
+
+  (void) arg;
+
+  if ( arquivo_lista ) {
+
+    FILE *f = strcmp(arquivo_lista, "-") ? fopen(arquivo_lista, "r") : stdin;
+    char *linha = NULL;
+    size_t tam = 0;
+    ssize_t n;
+
+    if ( !f ) {
+
+      perror(arquivo_lista);
+      erro_leitura = 1;
+    }
+    while ( f && (n = getline(&linha, &tam, f)) > 0 ) {
+
+      while ( n > 0 && (linha[n-1] == '\n' || linha[n-1] == '\r') )
+        linha[--n] = '\0';
+      if ( n > 0 )
+        le_nome(linha);
+    }
+    free(linha);
+    if ( f && f != stdin )
+      fclose(f);
+  }
+
+  for ( int i = 0; i < n_arquivos; ++i )
+    le_nome(arquivos[i]);
+
+  if ( !arquivo_lista && n_arquivos == 0 )
+    le_arquivo(stdin, "-");
+
+  pthread_mutex_lock(&trava);
+  fim_leitura = 1;
+  pthread_cond_broadcast(&tem_grafo);
+  pthread_cond_signal(&tem_pronta);
+  pthread_mutex_unlock(&trava);
+
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+// thread de emparelhamento: emparelha os grafos lidos, em ordem, até a
+// leitura acabar
+
+static void *thread_emparelhamento(void *arg) {
+
+  (void) arg;
+
+  for (;;) {
+
+    struct tarefa *t;
+
+    pthread_mutex_lock(&trava);
+    while ( emparelhando == lidos && !fim_leitura )
+      pthread_cond_wait(&tem_grafo, &trava);
+    if ( emparelhando == lidos ) {
+
+      pthread_mutex_unlock(&trava);
+      return NULL;
+    }
+    t = &janela[emparelhando++ % tam_janela];
+    pthread_mutex_unlock(&trava);
+
+    t->emparelhamento = bipartido(t->g, NULL) ? emparelhamento_maximo(t->g) : emparelhamento_geral(t->g);
+
+    pthread_mutex_lock(&trava);
+    t->pronta = 1;
+    pthread_cond_signal(&tem_pronta);
+    pthread_mutex_unlock(&trava);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+
+  long n_processadores = sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned long n_threads = n_processadores > 0 ? (unsigned long) n_processadores : 1;
+  pthread_t leitura, *threads;
+  int opcao;
+
+  while ( (opcao = getopt(argc, argv, "t:l:")) != -1 ) {
+
+    if ( opcao == 't' && atoi(optarg) > 0 )
+      n_threads = (unsigned long) atoi(optarg);
+    else if ( opcao == 'l' )
+      arquivo_lista = optarg;
+    else {
+
+      fprintf(stderr, "uso: lote [-t threads] [-l lista] [arquivo ...]\n");
+      return 1;
+    }
+  }
+  arquivos = argv + optind;
+  n_arquivos = argc - optind;
+
+  tam_janela = JANELA_POR_THREAD * n_threads;
+  janela = calloc(tam_janela, sizeof(struct tarefa));
+  threads = malloc(n_threads * sizeof(pthread_t));
+  if ( !janela || !threads ) {
+
+    perror("lote");
+    return 1;
+  }
+
+  // as threads de emparelhamento vêm antes da de leitura: se alguma não
+  // pode ser criada, as já criadas só esperam grafos e terminam com
+  // fim_leitura, sem nenhum grafo lido pela metade
+  for ( unsigned long i = 0; i <= n_threads; ++i ) {
+
+    int falha = i < n_threads
+      ? pthread_create(&threads[i], NULL, thread_emparelhamento, NULL)
+      : pthread_create(&leitura, NULL, thread_leitura, NULL);
+
+    if ( falha ) {
+
+      fprintf(stderr, "lote: erro ao criar as threads: %s\n", strerror(falha));
+      pthread_mutex_lock(&trava);
+      fim_leitura = 1;
+      pthread_cond_broadcast(&tem_grafo);
+      pthread_mutex_unlock(&trava);
+      while ( i-- > 0 )
+        pthread_join(threads[i], NULL);
+      free(janela);
+      free(threads);
+      return 1;
+    }
+  }
+
+  // escreve os grafos na ordem em que foram lidos
+  for (;;) {
+
+    struct tarefa *t;
+
+    pthread_mutex_lock(&trava);
+    while ( escritos == lidos ? !fim_leitura : !janela[escritos % tam_janela].pronta )
+      pthread_cond_wait(&tem_pronta, &trava);
+    if ( escritos == lidos ) {
+
+      pthread_mutex_unlock(&trava);
+      break;
+    }
+    t = &janela[escritos % tam_janela];
+    pthread_mutex_unlock(&trava);
+
+    if ( t->emparelhamento ) {
+
+      printf("// %lu %s %u %u %u\n", escritos, nome_grafo(t->g), n_vertices(t->g),
+             n_arestas(t->g), n_arestas(t->emparelhamento));
+      escreve_grafo(stdout, t->emparelhamento);
+      destroi_grafo(t->emparelhamento);
+    }
+    else {
+
+      printf("// %lu %s erro\n", escritos, nome_grafo(t->g));
+      erro = 1;
+    }
+    destroi_grafo(t->g);
+
+    pthread_mutex_lock(&trava);
+    ++escritos;
+    pthread_cond_signal(&tem_espaco);
+    pthread_mutex_unlock(&trava);
+  }
+
+  pthread_join(leitura, NULL);
+  for ( unsigned long i = 0; i < n_threads; ++i )
+    pthread_join(threads[i], NULL);
+
+  free(janela);
+  free(threads);
+
+  return erro || erro_leitura || fflush(stdout) != 0;
+}
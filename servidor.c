@@ -0,0 +1,827 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "grafo.h"
+
+//------------------------------------------------------------------------------
+// servidor que mantém grafos carregados entre consultas
+//
+// uso: servidor <socket> [threads [nome=arquivo.dot ...]]
+//
+// escuta no socket Unix <socket>; a thread principal espera (com poll()) por
+// dados em todas as conexões abertas, e a conexão que recebe dados vai para a
+// fila das threads, que executam as linhas completas recebidas e a devolvem;
+// assim uma conexão ociosa não ocupa thread, e as linhas de uma mesma conexão
+// são executadas em ordem, uma de cada vez
+//
+// aceita até MAX_CONEXOES conexões abertas ao mesmo tempo (as demais são
+// fechadas logo que aceitas) e fecha as que passam TEMPO_OCIOSO segundos sem
+// enviar nada
+//
+// cada linha recebida é um comando e cada resposta começa com uma linha
+// "ok ..." ou "erro ..."; respostas com uma lista têm "ok <n>" seguida de n
+// linhas
+//
+// os argumentos são separados por espaços ou, se a linha tem alguma
+// tabulação, só por tabulações (para nomes com espaços); as arestas das
+// respostas também têm os vértices separados por tabulação
+//
+//   carrega <nome> <arquivo>       lê o grafo do arquivo (formato dot); o
+//                                  nome tem até 63 caracteres
+//   descarrega <nome>
+//   grafos                         nomes dos grafos carregados
+//   emparelhamento <nome>          arestas de um emparelhamento máximo
+//   cordal <nome>                  ok 1 ou ok 0
+//   clique <nome>                  vértices de uma clique máxima (g cordal)
+//   grau <nome> <vertice>
+//   insere <nome> <u> <v> [peso]   cria u e v se preciso (e os remove se a
+//                                  aresta não pode ser inserida)
+//   remove <nome> <u> <v>
+//   metricas                       <comando> <n> <media_us> <max_us>
+//   sair                           fecha a conexão
+//   desliga                        encerra o servidor
+//
+// consultas a grafos diferentes executam em paralelo; as consultas a um
+// mesmo grafo (que usa marcas internas nos vértices) são serializadas
+//
+// emparelhamentos e vereditos de cordal ficam num cache indexado pelo hash
+// canônico dos grafos (ver hash_grafo()), então consultas repetidas, mesmo a
+// grafos iguais carregados com outro nome, não refazem as contas; o cache
+// ocupa no máximo 64 MiB, descartando os resultados usados há mais tempo
+
+#define TAM_LINHA 1024
+#define TAM_NOME_GRAFO 64
+#define MAX_CONEXOES 64
+#define TEMPO_OCIOSO 300
+
+//------------------------------------------------------------------------------
+// grafo carregado; refs conta as consultas em andamento, e o grafo só é
+// desalocado depois que a última terminar
+
+struct entrada {
+  char nome[TAM_NOME_GRAFO];
+  grafo g;
+  pthread_mutex_t trava;
+  struct entrada *prox;
+  unsigned int refs;
+  int removido;
+};
+
+//------------------------------------------------------------------------------
+// latência acumulada de um comando
+
+struct metrica {
+  const char *comando;
+  unsigned long n, soma_us, max_us;
+};
+
+static struct metrica metricas[] = {
+  { "carrega", 0, 0, 0 }, { "descarrega", 0, 0, 0 }, { "grafos", 0, 0, 0 },
+  { "emparelhamento", 0, 0, 0 }, { "cordal", 0, 0, 0 }, { "clique", 0, 0, 0 },
+  { "grau", 0, 0, 0 }, { "insere", 0, 0, 0 }, { "remove", 0, 0, 0 },
+  { "metricas", 0, 0, 0 }
+};
+
+#define N_METRICAS (sizeof(metricas) / sizeof(metricas[0]))
+
+//------------------------------------------------------------------------------
+// conexão aberta; linha guarda os usado bytes recebidos e ainda não
+// executados (o fim de uma linha incompleta)
+//
+// ocupada indica que a conexão está na fila ou sendo atendida por uma thread,
+// e fechar que a thread terminou a conexão; os dois são protegidos por
+// trava_fila, e o resto só é usado por quem tem a conexão
+
+struct conexao {
+  FILE *saida;
+  char linha[TAM_LINHA];
+  size_t usado;
+  unsigned long ultimo_us;
+  int fd, ocupada, fechar, padding;
+};
+
+static struct entrada *grafos = NULL;
+static pthread_mutex_t trava_grafos = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t trava_leitura = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t trava_metricas = PTHREAD_MUTEX_INITIALIZER;
+
+// conexões abertas e fila das que têm dados e ainda não foram atendidas;
+// cada conexão entra na fila no máximo uma vez, então a fila não enche
+static struct conexao *conexoes[MAX_CONEXOES];
+static struct conexao *fila[MAX_CONEXOES];
+static unsigned int inicio_fila = 0, tamanho_fila = 0;
+static pthread_mutex_t trava_fila = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tem_conexao = PTHREAD_COND_INITIALIZER;
+
+// pipe que acorda o poll() da thread principal
+static int acorda[2] = { -1, -1 };
+
+static unsigned int n_threads = 4;
+static int escuta = -1;
+static volatile int desligando = 0;
+static cache_grafo cache = NULL;
+
+//------------------------------------------------------------------------------
+// devolve o instante atual em microssegundos
+
+static unsigned long agora_us(void) {
+
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (unsigned long) t.tv_sec * 1000000ul + (unsigned long) t.tv_nsec / 1000ul;
+}
+
+//------------------------------------------------------------------------------
+// acorda a thread principal para refazer o conjunto do poll()
+
+static void acorda_principal(void) {
+
+  char c = 0;
+
+  // o pipe não bloqueia; se está cheio a thread principal já vai acordar
+  if ( write(acorda[1], &c, 1) < 0 )
+    return;
+}
+
+//------------------------------------------------------------------------------
+// devolve a entrada do grafo de nome nome com uma referência a mais,
+//      ou NULL se não existe
+
+static struct entrada *pega_grafo(const char *nome) {
+
+  struct entrada *e;
+
+  pthread_mutex_lock(&trava_grafos);
+  for ( e = grafos; e && strcmp(e->nome, nome); e = e->prox )
+    ;
+  if ( e )
+    ++e->refs;
+  pthread_mutex_unlock(&trava_grafos);
+
+  if ( e )
+    pthread_mutex_lock(&e->trava);
+
+  return e;
+}
+
+//------------------------------------------------------------------------------
+// devolve a referência a e obtida com pega_grafo()
+
+static void solta_grafo(struct entrada *e) {
+
+  int libera;
+
+  pthread_mutex_unlock(&e->trava);
+
+  pthread_mutex_lock(&trava_grafos);
+  libera = --e->refs == 0 && e->removido;
+  pthread_mutex_unlock(&trava_grafos);
+
+  if ( libera ) {
+
+    destroi_grafo(e->g);
+    pthread_mutex_destroy(&e->trava);
+    free(e);
+  }
+}
+
+//------------------------------------------------------------------------------
+// lê o grafo do arquivo e o guarda com o nome nome, substituindo o anterior
+//
+// devolve 1 em caso de sucesso ou 0 caso contrário (inclusive se nome não
+// cabe em TAM_NOME_GRAFO - 1 caracteres)
+
+static int carrega(const char *nome, const char *arquivo) {
+
+  struct entrada *e, **a;
+  FILE *f;
+  grafo g;
+
+  if ( strlen(nome) >= TAM_NOME_GRAFO || !(f = fopen(arquivo, "r")) )
+    return 0;
+
+  // a libcgraph não garante leituras simultâneas
+  pthread_mutex_lock(&trava_leitura);
+  g = le_grafo(f);
+  pthread_mutex_unlock(&trava_leitura);
+  fclose(f);
+
+  if ( !g || !(e = calloc(1, sizeof(struct entrada))) ) {
+
+    if ( g )
+      destroi_grafo(g);
+    return 0;
+  }
+
+  strncpy(e->nome, nome, TAM_NOME_GRAFO - 1);
+  e->g = g;
+  pthread_mutex_init(&e->trava, NULL);
+
+  pthread_mutex_lock(&trava_grafos);
+  for ( a = &grafos; *a && strcmp((*a)->nome, nome); a = &(*a)->prox )
+    ;
+  if ( *a ) {
+
+    // substitui: o anterior sai da lista e é liberado na última referência
+    e->prox = (*a)->prox;
+    (*a)->removido = 1;
+    if ( (*a)->refs == 0 ) {
+
+      destroi_grafo((*a)->g);
+      pthread_mutex_destroy(&(*a)->trava);
+      free(*a);
+    }
+    *a = e;
+  }
+  else {
+
+    e->prox = grafos;
+    grafos = e;
+  }
+  pthread_mutex_unlock(&trava_grafos);
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+// tira o grafo de nome nome do servidor
+//
+// devolve 1 em caso de sucesso ou 0 se não existe
+
+static int descarrega(const char *nome) {
+
+  struct entrada *e, **a;
+
+  pthread_mutex_lock(&trava_grafos);
+  for ( a = &grafos; *a && strcmp((*a)->nome, nome); a = &(*a)->prox )
+    ;
+  e = *a;
+  if ( e ) {
+
+    *a = e->prox;
+    e->removido = 1;
+    if ( e->refs == 0 ) {
+
+      destroi_grafo(e->g);
+      pthread_mutex_destroy(&e->trava);
+      free(e);
+    }
+  }
+  pthread_mutex_unlock(&trava_grafos);
+
+  return e != NULL;
+}
+
+//------------------------------------------------------------------------------
+// escreve em saida "ok <n>" e os nomes dos vértices da lista l
+
+static void escreve_vertices(FILE *saida, lista l) {
+
+  fprintf(saida, "ok %u\n", tamanho_lista(l));
+  for ( no n = primeiro_no(l); n; n = proximo_no(n) )
+    fprintf(saida, "%s\n", nome_vertice(conteudo(n)));
+}
+
+//------------------------------------------------------------------------------
+// escreve em saida "ok <n>" e as n arestas do emparelhamento e
+
+static void escreve_emparelhamento(FILE *saida, grafo e) {
+
+  fprintf(saida, "ok %u\n", n_arestas(e));
+  for ( no n = primeiro_no(vertices_grafo(e)); n; n = proximo_no(n) ) {
+
+    vertice v = conteudo(n);
+    lista viz = vizinhanca(v, 0, e);
+
+    for ( no m = primeiro_no(viz); m; m = proximo_no(m) )
+      if ( strcmp(nome_vertice(v), nome_vertice(conteudo(m))) < 0 )
+        fprintf(saida, "%s\t%s\n", nome_vertice(v), nome_vertice(conteudo(m)));
+
+    destroi_lista(viz, NULL);
+  }
+}
+
+//------------------------------------------------------------------------------
+// executa o comando com argumentos arg[0 .. n_arg) sobre o grafo e
+// (já travado) e escreve a resposta em saida
+
+static void consulta(FILE *saida, const char *comando, char **arg, int n_arg, struct entrada *e) {
+
+  grafo g = e->g;
+  vertice u, v;
+
+  if ( !strcmp(comando, "emparelhamento") ) {
+
+    grafo emp = emparelhamento_maximo_cache(cache, g);
+
+    if ( !emp )
+      emp = emparelhamento_geral(g);
+
+    if ( !emp ) {
+
+      fprintf(saida, "erro emparelhamento\n");
+      return;
+    }
+    escreve_emparelhamento(saida, emp);
+    destroi_grafo(emp);
+  }
+  else if ( !strcmp(comando, "cordal") )
+
+    fprintf(saida, "ok %d\n", cordal_cache(cache, g));
+
+  else if ( !strcmp(comando, "clique") ) {
+
+    lista ordem = ordem_cordal(g), clique;
+
+    if ( !ordem ) {
+
+      fprintf(saida, "erro grafo nao cordal\n");
+      return;
+    }
+    clique = clique_maxima(ordem, g);
+    escreve_vertices(saida, clique);
+    destroi_lista(clique, NULL);
+    destroi_lista(ordem, NULL);
+  }
+  else if ( !strcmp(comando, "grau") && n_arg >= 2 ) {
+
+    if ( !(v = procura_vertice(g, arg[1])) )
+      fprintf(saida, "erro vertice inexistente\n");
+    else
+      fprintf(saida, "ok %u\n", grau(v, 0, g));
+  }
+  else if ( !strcmp(comando, "insere") && n_arg >= 3 ) {
+
+    int novo_u = 0, novo_v = 0;
+
+    if ( !(u = procura_vertice(g, arg[1])) && (u = insere_vertice(g, arg[1])) )
+      novo_u = 1;
+    if ( u && !(v = procura_vertice(g, arg[2])) && (v = insere_vertice(g, arg[2])) )
+      novo_v = 1;
+
+    if ( u && v && insere_aresta_entre(g, u, v, n_arg >= 4 ? atol(arg[3]) : 0) )
+      fprintf(saida, "ok\n");
+    else {
+
+      // desfaz os vértices criados para a aresta que não entrou
+      if ( novo_v )
+        remove_vertice(g, v);
+      if ( novo_u )
+        remove_vertice(g, u);
+      fprintf(saida, "erro aresta nao inserida\n");
+    }
+  }
+  else if ( !strcmp(comando, "remove") && n_arg >= 3 ) {
+
+    u = procura_vertice(g, arg[1]);
+    v = procura_vertice(g, arg[2]);
+
+    if ( u && v && remove_aresta_entre(g, u, v) )
+      fprintf(saida, "ok\n");
+    else
+      fprintf(saida, "erro aresta inexistente\n");
+  }
+  else
+
+    fprintf(saida, "erro argumentos\n");
+}
+
+//------------------------------------------------------------------------------
+// executa a linha de comando e escreve a resposta em saida
+//
+// devolve 0 se a conexão deve ser fechada ou 1 caso contrário
+
+static int executa(FILE *saida, char *linha) {
+
+  char *arg[8], *resto;
+  const char *separa = strchr(linha, '\t') ? "\t\r\n" : " \t\r\n";
+  int n_arg = 0;
+  unsigned long t0 = agora_us(), dt;
+  unsigned int i;
+  struct entrada *e;
+
+  for ( char *p = strtok_r(linha, separa, &resto); p && n_arg < 8; p = strtok_r(NULL, separa, &resto) )
+    arg[n_arg++] = p;
+
+  if ( n_arg == 0 )
+    return 1;
+
+  if ( !strcmp(arg[0], "sair") )
+    return 0;
+
+  if ( !strcmp(arg[0], "desliga") ) {
+
+    // responde antes de acordar a thread principal, que derruba as conexões
+    fprintf(saida, "ok\n");
+    fflush(saida);
+    desligando = 1;
+    acorda_principal();
+    return 0;
+  }
+
+  for ( i = 0; i < N_METRICAS && strcmp(arg[0], metricas[i].comando); ++i )
+    ;
+
+  if ( i == N_METRICAS ) {
+
+    fprintf(saida, "erro comando desconhecido\n");
+    return 1;
+  }
+
+  if ( !strcmp(arg[0], "carrega") ) {
+
+    if ( n_arg >= 3 && strlen(arg[1]) >= TAM_NOME_GRAFO )
+      fprintf(saida, "erro nome longo\n");
+    else
+      fprintf(saida, n_arg >= 3 && carrega(arg[1], arg[2]) ? "ok\n" : "erro carga\n");
+  }
+
+  else if ( !strcmp(arg[0], "descarrega") )
+
+    fprintf(saida, n_arg >= 2 && descarrega(arg[1]) ? "ok\n" : "erro grafo inexistente\n");
+
+  else if ( !strcmp(arg[0], "grafos") ) {
+
+    unsigned int n = 0;
+
+    pthread_mutex_lock(&trava_grafos);
+    for ( e = grafos; e; e = e->prox )
+      ++n;
+    fprintf(saida, "ok %u\n", n);
+    for ( e = grafos; e; e = e->prox )
+      fprintf(saida, "%s\n", e->nome);
+    pthread_mutex_unlock(&trava_grafos);
+  }
+  else if ( !strcmp(arg[0], "metricas") ) {
+
+    pthread_mutex_lock(&trava_metricas);
+    fprintf(saida, "ok %u\n", (unsigned int) N_METRICAS);
+    for ( unsigned int j = 0; j < N_METRICAS; ++j )
+      fprintf(saida, "%s %lu %lu %lu\n", metricas[j].comando, metricas[j].n,
+              metricas[j].n ? metricas[j].soma_us / metricas[j].n : 0, metricas[j].max_us);
+    pthread_mutex_unlock(&trava_metricas);
+  }
+  else if ( n_arg < 2 || !(e = pega_grafo(arg[1])) )
+
+    fprintf(saida, "erro grafo inexistente\n");
+
+  else {
+
+    consulta(saida, arg[0], arg + 1, n_arg - 1, e);
+    solta_grafo(e);
+  }
+
+  dt = agora_us() - t0;
+  pthread_mutex_lock(&trava_metricas);
+  ++metricas[i].n;
+  metricas[i].soma_us += dt;
+  if ( dt > metricas[i].max_us )
+    metricas[i].max_us = dt;
+  pthread_mutex_unlock(&trava_metricas);
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+// abre uma conexão para o socket fd
+//
+// devolve a conexão ou NULL em caso de erro, fechando fd
+
+static struct conexao *abre_conexao(int fd) {
+
+  struct conexao *c = calloc(1, sizeof(struct conexao));
+  int fd2 = dup(fd);
+
+  if ( !c || fd2 < 0 || !(c->saida = fdopen(fd2, "w")) ) {
+
+    if ( fd2 >= 0 )
+      close(fd2);
+    close(fd);
+    free(c);
+    return NULL;
+  }
+
+  c->fd = fd;
+  c->ultimo_us = agora_us();
+
+  return c;
+}
+
+//------------------------------------------------------------------------------
+// fecha a conexão c
+
+static void fecha_conexao(struct conexao *c) {
+
+  fclose(c->saida);
+  close(c->fd);
+  free(c);
+}
+
+//------------------------------------------------------------------------------
+// lê o que chegou na conexão c e executa as linhas completas
+//
+// uma linha maior que o buffer é executada em pedaços, como faria fgets()
+//
+// devolve 0 se a conexão deve ser fechada ou 1 caso contrário
+
+static int atende(struct conexao *c) {
+
+  char linha[TAM_LINHA], *inicio = c->linha;
+  ssize_t lidos;
+  size_t resta;
+
+  // o poll() avisou que há dados, então o read() não bloqueia
+  lidos = read(c->fd, c->linha + c->usado, sizeof(c->linha) - 1 - c->usado);
+  if ( lidos <= 0 )
+    return 0;
+
+  resta = c->usado + (size_t) lidos;
+
+  while ( !desligando && resta > 0 ) {
+
+    char *fim = memchr(inicio, '\n', resta);
+    size_t tamanho;
+    int continua;
+
+    if ( fim )
+      tamanho = (size_t) (fim - inicio) + 1;
+    else if ( resta == sizeof(c->linha) - 1 )
+      tamanho = resta;
+    else
+      break;
+
+    memcpy(linha, inicio, tamanho);
+    linha[tamanho] = '\0';
+    inicio += tamanho;
+    resta -= tamanho;
+
+    continua = executa(c->saida, linha);
+    fflush(c->saida);
+    if ( !continua )
+      return 0;
+  }
+
+  memmove(c->linha, inicio, resta);
+  c->usado = resta;
+
+  return !desligando;
+}
+
+//------------------------------------------------------------------------------
+// thread do conjunto: atende as conexões da fila até o servidor desligar
+
+static void *thread_servidor(void *arg) {
+
+  (void) arg;
+
+  for (;;) {
+
+    struct conexao *c;
+    int continua;
+
+    pthread_mutex_lock(&trava_fila);
+    while ( tamanho_fila == 0 && !desligando )
+      pthread_cond_wait(&tem_conexao, &trava_fila);
+    if ( desligando ) {
+
+      pthread_mutex_unlock(&trava_fila);
+      return NULL;
+    }
+    c = fila[inicio_fila];
+    inicio_fila = (inicio_fila + 1) % MAX_CONEXOES;
+    --tamanho_fila;
+    pthread_mutex_unlock(&trava_fila);
+
+    continua = atende(c);
+
+    pthread_mutex_lock(&trava_fila);
+    c->ocupada = 0;
+    c->fechar = !continua;
+    c->ultimo_us = agora_us();
+    pthread_mutex_unlock(&trava_fila);
+
+    acorda_principal();
+  }
+}
+
+//------------------------------------------------------------------------------
+// aceita uma conexão em escuta e a guarda numa posição livre de conexoes[];
+// sem posição livre a conexão é fechada
+
+static void aceita(void) {
+
+  struct conexao *c;
+  unsigned int i;
+  int fd = accept(escuta, NULL, NULL);
+
+  if ( fd < 0 )
+    return;
+
+  // só a thread principal mexe em conexoes[]
+  for ( i = 0; i < MAX_CONEXOES && conexoes[i]; ++i )
+    ;
+
+  if ( i == MAX_CONEXOES ) {
+
+    close(fd);
+    return;
+  }
+
+  if ( (c = abre_conexao(fd)) )
+    conexoes[i] = c;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+
+  struct sockaddr_un endereco;
+  pthread_t *threads;
+  unsigned int i;
+
+  if ( argc < 2 || strlen(argv[1]) >= sizeof(endereco.sun_path) ) {
+
+    fprintf(stderr, "uso: %s <socket> [threads [nome=arquivo.dot ...]]\n", argv[0]);
+    return 1;
+  }
+
+  if ( !(cache = constroi_cache_grafo(NULL, 0)) )
+    return 1;
+
+  if ( argc >= 3 && atoi(argv[2]) > 0 )
+    n_threads = (unsigned int) atoi(argv[2]);
+
+  for ( int k = 3; k < argc; ++k ) {
+
+    char *igual = strchr(argv[k], '=');
+
+    if ( !igual ) {
+
+      fprintf(stderr, "grafo inválido: %s\n", argv[k]);
+      return 1;
+    }
+    *igual = '\0';
+    if ( strlen(argv[k]) >= TAM_NOME_GRAFO ) {
+
+      fprintf(stderr, "nome de grafo longo demais: %s\n", argv[k]);
+      return 1;
+    }
+    if ( !carrega(argv[k], igual + 1) ) {
+
+      fprintf(stderr, "erro ao carregar %s\n", igual + 1);
+      return 1;
+    }
+  }
+
+  memset(&endereco, 0, sizeof(endereco));
+  endereco.sun_family = AF_UNIX;
+  strcpy(endereco.sun_path, argv[1]);
+  unlink(argv[1]);
+
+  if ( (escuta = socket(AF_UNIX, SOCK_STREAM, 0)) < 0
+       || bind(escuta, (struct sockaddr *) &endereco, sizeof(endereco)) != 0
+       || listen(escuta, MAX_CONEXOES) != 0 ) {
+
+    perror("servidor");
+    return 1;
+  }
+
+  // com escuta e o pipe sem bloquear, um aviso falso do poll() não trava o laço
+  if ( pipe(acorda) != 0
+       || fcntl(escuta, F_SETFL, O_NONBLOCK) != 0
+       || fcntl(acorda[0], F_SETFL, O_NONBLOCK) != 0
+       || fcntl(acorda[1], F_SETFL, O_NONBLOCK) != 0 ) {
+
+    perror("servidor");
+    return 1;
+  }
+
+  threads = malloc(n_threads * sizeof(pthread_t));
+  if ( !threads ) {
+
+    perror("servidor");
+    return 1;
+  }
+
+  for ( i = 0; i < n_threads; ++i ) {
+
+    int erro = pthread_create(&threads[i], NULL, thread_servidor, NULL);
+
+    if ( erro ) {
+
+      // desfaz a partida: as threads já criadas só esperam conexões
+      fprintf(stderr, "servidor: erro ao criar as threads: %s\n", strerror(erro));
+      desligando = 1;
+      pthread_mutex_lock(&trava_fila);
+      pthread_cond_broadcast(&tem_conexao);
+      pthread_mutex_unlock(&trava_fila);
+      while ( i-- > 0 )
+        pthread_join(threads[i], NULL);
+      free(threads);
+      close(escuta);
+      unlink(argv[1]);
+      return 1;
+    }
+  }
+
+  while ( !desligando ) {
+
+    struct pollfd espera[MAX_CONEXOES + 2];
+    struct conexao *conexao[MAX_CONEXOES + 2];
+    unsigned long agora = agora_us();
+    nfds_t n = 2;
+    char lixo[64];
+
+    espera[0].fd = escuta;
+    espera[0].events = POLLIN;
+    espera[1].fd = acorda[0];
+    espera[1].events = POLLIN;
+
+    // espera pelas conexões que não estão com nenhuma thread, fechando as
+    // terminadas e as ociosas
+    pthread_mutex_lock(&trava_fila);
+    for ( i = 0; i < MAX_CONEXOES; ++i ) {
+
+      struct conexao *c = conexoes[i];
+
+      if ( !c || c->ocupada )
+        continue;
+
+      if ( c->fechar || agora - c->ultimo_us >= TEMPO_OCIOSO * 1000000ul ) {
+
+        fecha_conexao(c);
+        conexoes[i] = NULL;
+        continue;
+      }
+      espera[n].fd = c->fd;
+      espera[n].events = POLLIN;
+      conexao[n++] = c;
+    }
+    pthread_mutex_unlock(&trava_fila);
+
+    if ( poll(espera, n, 1000) < 0 ) {
+
+      if ( errno == EINTR )
+        continue;
+      perror("servidor");
+      break;
+    }
+
+    if ( espera[1].revents )
+      while ( read(acorda[0], lixo, sizeof(lixo)) > 0 )
+        ;
+
+    // fim de conexão e erro também vão para a fila: o read() da thread vê
+    pthread_mutex_lock(&trava_fila);
+    for ( nfds_t k = 2; k < n; ++k )
+      if ( espera[k].revents ) {
+
+        conexao[k]->ocupada = 1;
+        fila[(inicio_fila + tamanho_fila++) % MAX_CONEXOES] = conexao[k];
+        pthread_cond_signal(&tem_conexao);
+      }
+    pthread_mutex_unlock(&trava_fila);
+
+    if ( espera[0].revents & POLLIN )
+      aceita();
+  }
+
+  // acorda as threads e derruba as conexões que elas atendem
+  desligando = 1;
+  pthread_mutex_lock(&trava_fila);
+  pthread_cond_broadcast(&tem_conexao);
+  for ( i = 0; i < MAX_CONEXOES; ++i )
+    if ( conexoes[i] && conexoes[i]->ocupada )
+      shutdown(conexoes[i]->fd, SHUT_RDWR);
+  pthread_mutex_unlock(&trava_fila);
+
+  for ( i = 0; i < n_threads; ++i )
+    pthread_join(threads[i], NULL);
+
+  for ( i = 0; i < MAX_CONEXOES; ++i )
+    if ( conexoes[i] )
+      fecha_conexao(conexoes[i]);
+
+  close(acorda[0]);
+  close(acorda[1]);
+  close(escuta);
+  unlink(argv[1]);
+
+  while ( grafos )
+    descarrega(grafos->nome);
+
+  free(threads);
+  destroi_cache_grafo(cache);
+
+  return 0;
+}
@@ -20,7 +20,14 @@ int main(void) {
 
   escreve_grafo(stdout,g);
 
-  grafo emparelhamento = emparelhamento_maximo(g);
+  grafo emparelhamento = bipartido(g, NULL) ? emparelhamento_maximo(g) : emparelhamento_geral(g);
+
+  if ( !emparelhamento ) {
+
+    destroi_grafo(g);
+    return 1;
+  }
+
   escreve_grafo(stdout,emparelhamento);
   printf("Tamanho do Emparelhamento: Arestas = %d, Vertices = %d\n", n_arestas(emparelhamento), n_vertices(emparelhamento));
 